@@ -6,12 +6,37 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <exception>
+#include <future>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define BIOPARSER_USE_MMAP
+#endif
+
 #include "zlib.h"
 #include "kseq.h"
 
@@ -20,12 +45,26 @@ namespace bioparser {
 static const std::string version = "v2.0.1";
 
 constexpr std::uint32_t kBufferSize = 64 * 1024;
+constexpr std::uint32_t kWriterBlockSize = 128 * 1024;
 
 // Small/Medium/Large Storage Size
 constexpr std::uint32_t kSSS = 4 * 1024;
 constexpr std::uint32_t kMSS = 8 * 1024 * 1024;
 constexpr std::uint32_t kLSS = 512 * 1024 * 1024;
 
+// Number of BGZF blocks (up to 64 KiB each) inflated in parallel per refill
+constexpr std::uint32_t kBgzfBatchSize = 64;
+
+/*!
+ * @brief Thrown when the first record of a batch does not fit into max_bytes
+ */
+class ChunkSizeError: public std::invalid_argument {
+public:
+    explicit ChunkSizeError(const std::string& what)
+            : std::invalid_argument(what) {
+    }
+};
+
 /*!
  * @brief Parser absctract class
  */
@@ -33,6 +72,16 @@ template<class T>
 class Parser;
 
 template<template<class> class P, class T>
+std::unique_ptr<P<T>> createParser(const std::string& path);
+
+/*!
+ * @brief Formats recognized from the first decompressed block of a file
+ */
+enum class Format {
+    kUnknown, kFasta, kFastq, kMhap, kPaf, kSam, kBam, kGfa, kTwoBit, kBed
+};
+
+template<class T>
 std::unique_ptr<Parser<T>> createParser(const std::string& path);
 
 /*!
@@ -56,6 +105,505 @@ class PafParser;
 template<class T>
 class SamParser;
 
+template<class T>
+class BamParser;
+
+template<class T>
+class GfaParser;
+
+template<class T>
+class TwoBitParser;
+
+template<class T>
+class BedParser;
+
+template<template<class> class P, class T>
+class MultiParser;
+
+template<template<class> class P, class T>
+std::unique_ptr<MultiParser<P, T>> createParser(
+    const std::vector<std::string>& paths);
+
+template<template<class> class P, class T>
+std::unique_ptr<MultiParser<P, T>> createParser(
+    std::initializer_list<std::string> paths);
+
+/*!
+ * @brief Compile time options of StaticParser, names are cut at the first
+ * whitespace (kHard) or stripped of trailing whitespace (kSoft), minimal
+ * validation only keeps the checks parsing itself depends on
+ */
+enum class Trim {
+    kSoft, kHard
+};
+
+enum class Validation {
+    kMinimal, kFull
+};
+
+template<Trim trim = Trim::kHard, Validation validation = Validation::kFull>
+struct ParseOptions {
+    static constexpr Trim kTrim = trim;
+    static constexpr Validation kValidation = validation;
+};
+
+template<template<class> class P, class T, class O = ParseOptions<>>
+class StaticParser;
+
+/*!
+ * @brief Writer definitions (outputs are gzip compressed if the path ends
+ * with .gz)
+ */
+class Writer;
+
+template<class W>
+std::unique_ptr<W> createWriter(const std::string& path);
+
+class PafWriter;
+
+class SamWriter;
+
+class MhapWriter;
+
+/*!
+ * @brief Columnar binary cache of parsed records stored next to the input
+ * file and keyed by its size, modification and change times and inode; the
+ * cache is mapped into memory on POSIX systems and read at once elsewhere
+ */
+class ParserCache {
+public:
+    /*!
+     * @brief View of one cached record, columns are numbered by the order of
+     * constructor arguments with strings and their lengths sharing a column
+     */
+    class Record {
+    public:
+        const char* string(std::uint32_t column) const;
+        std::uint32_t length(std::uint32_t column) const;
+        template<class U>
+        U value(std::uint32_t column) const;
+
+    private:
+        friend ParserCache;
+        Record(const std::vector<const char*>& columns,
+            const std::vector<const char*>& strings, std::uint64_t id);
+
+        const std::vector<const char*>& columns_;
+        const std::vector<const char*>& strings_;
+        std::uint64_t id_;
+    };
+
+    ParserCache(const std::string& path, const std::string& format);
+    ~ParserCache();
+
+    bool is_mapped() const;
+    const std::string& format() const;
+
+    template<class... Args>
+    void store(Args... args);
+
+    // writes stored records as a block and completes the cache at the end
+    void flush(bool is_last);
+
+    // create returns true once the batch is full
+    template<class F>
+    bool load(std::uint64_t max_bytes, F create);
+
+    void rewind();
+
+private:
+    ParserCache(const ParserCache&) = delete;
+    const ParserCache& operator=(const ParserCache&) = delete;
+
+    struct Column {
+        std::uint8_t width;
+        std::vector<char> data;
+        std::vector<std::uint64_t> offsets;
+    };
+
+    void store_values() {}
+    template<class... Args>
+    void store_values(const char* src, std::uint32_t src_length, Args... args);
+    template<class U, class... Args>
+    void store_values(U value, Args... args);
+    Column& column(std::uint8_t width);
+
+    std::string path_;
+    std::string format_;
+    std::string header_;
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> cache_file_;
+    std::vector<Column> columns_;
+    std::uint32_t column_id_;
+    std::uint64_t num_records_;
+
+    std::vector<char> buffer_;  // holds the cache where mmap is unavailable
+    const char* data_;
+    std::uint64_t data_length_;
+    std::uint64_t data_begin_;
+    std::uint64_t record_id_;
+};
+
+/*!
+ * @brief Struct-of-arrays storage of BED intervals with interned chromosome
+ * names, intervals of chromosome i are [offsets()[i], offsets()[i + 1]) and
+ * sorted by begin
+ */
+class BedIntervals {
+public:
+    BedIntervals();
+
+    const std::vector<std::string>& names() const;
+    const std::vector<std::uint64_t>& offsets() const;
+    const std::vector<std::uint32_t>& begins() const;
+    const std::vector<std::uint32_t>& ends() const;
+    // running maximum of ends within each chromosome
+    const std::vector<std::uint32_t>& max_ends() const;
+
+    // returns -1 for unknown chromosomes
+    std::uint32_t id(const std::string& name) const;
+
+    /*!
+     * @brief True if [begin, end) overlaps any interval of the chromosome,
+     * found with a binary search over begins
+     */
+    bool overlaps(std::uint32_t id, std::uint32_t begin,
+        std::uint32_t end) const;
+    bool overlaps(const std::string& name, std::uint32_t begin,
+        std::uint32_t end) const;
+
+private:
+    template<class T>
+    friend class BedParser;
+
+    std::uint32_t intern(const char* name, std::uint32_t name_length);
+    // merges intervals added since the last call into the sorted arrays
+    void sort();
+
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    std::uint32_t last_id_;
+    std::vector<std::uint64_t> offsets_;
+    std::vector<std::uint32_t> begins_;
+    std::vector<std::uint32_t> ends_;
+    std::vector<std::uint32_t> max_ends_;
+    std::vector<std::uint32_t> new_ids_;
+    std::vector<std::uint32_t> new_begins_;
+    std::vector<std::uint32_t> new_ends_;
+};
+
+/*!
+ * @brief Reference dictionary of SAM @SQ header lines (or of the BAM
+ * reference list), ids are given in order of appearance
+ */
+class SamHeader {
+public:
+    SamHeader();
+
+    std::uint32_t size() const;
+    const std::string& name(std::uint32_t id) const;
+    std::uint32_t length(std::uint32_t id) const;
+
+    // returns -1 for unknown references
+    std::uint32_t id(const char* name, std::uint32_t name_length) const;
+    std::uint32_t id(const std::string& name) const;
+
+private:
+    template<class T>
+    friend class SamParser;
+    template<class T>
+    friend class BamParser;
+
+    void clear();
+    // returns false if the name is already present
+    bool add(const char* name, std::uint32_t name_length,
+        std::uint32_t length);
+    // adds the reference of an @SQ line, other lines are ignored
+    void parse(const char* line, std::uint32_t line_length);
+
+    std::vector<std::string> names_;
+    std::vector<std::uint32_t> lengths_;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    // records are usually sorted by reference
+    mutable std::uint32_t last_id_;
+};
+
+/*!
+ * @brief Lazy view of the optional fields of a SAM record which is valid
+ * during the constructor call only, tags are indexed on the first lookup
+ */
+class SamTags {
+public:
+    SamTags();
+
+    // raw tab separated optional fields
+    const char* data() const;
+    std::uint32_t length() const;
+
+    std::uint32_t size() const;
+
+    /*!
+     * @brief Finds a tag by its two character name and returns its type
+     * (one of AifZHB) and its value as written in the record
+     */
+    bool find(const char* tag, char& type, const char*& value,
+        std::uint32_t& value_length) const;
+    // for tags of type i
+    bool find(const char* tag, std::int64_t& value) const;
+    // for tags of type f
+    bool find(const char* tag, double& value) const;
+
+private:
+    template<class T>
+    friend class SamParser;
+
+    void reset(const char* data, std::uint32_t data_length);
+    void index() const;
+
+    const char* data_;
+    std::uint32_t data_length_;
+    mutable bool is_indexed_;
+    // begins of fields, reused between records
+    mutable std::vector<std::uint32_t> offsets_;
+};
+
+/*!
+ * @brief CIGAR of a SAM record decoded into BAM encoded operations
+ * (length << 4 | op, with op being the index in MIDNSHP=X) together with
+ * spans and base counts gathered in the same pass, valid during the
+ * constructor call only
+ */
+class SamCigar {
+public:
+    SamCigar();
+
+    const std::uint32_t* data() const;
+    std::uint32_t size() const;
+
+    // bases consumed by M, I, S, = and X operations
+    std::uint32_t query_span() const;
+    // bases consumed by M, D, N, = and X operations
+    std::uint32_t target_span() const;
+    // bases in M, = and X operations
+    std::uint32_t aligned_bases() const;
+    // bases in = operations
+    std::uint32_t matches() const;
+    // bases in X operations
+    std::uint32_t mismatches() const;
+    std::uint32_t insertions() const;
+    std::uint32_t deletions() const;
+
+private:
+    template<class T>
+    friend class SamParser;
+
+    // returns false if src is not a valid CIGAR ('*' is valid and empty)
+    bool reset(const char* src, std::uint32_t src_length);
+
+    std::vector<std::uint32_t> operations_;
+    std::uint32_t query_span_;
+    std::uint32_t target_span_;
+    std::uint32_t aligned_bases_;
+    std::uint32_t matches_;
+    std::uint32_t mismatches_;
+    std::uint32_t insertions_;
+    std::uint32_t deletions_;
+};
+
+/*!
+ * @brief Predicates evaluated by FASTA and FASTQ parsers before records are
+ * constructed, sequences longer than max_length are not copied any further
+ * once their length exceeds it
+ */
+struct ReadFilter {
+    ReadFilter();
+
+    std::uint32_t min_length;
+    std::uint32_t max_length;
+    // arithmetic mean of Phred scores (Phred+33), FASTQ only and ignored if
+    // T takes no qualities
+    double min_mean_quality;
+    // fraction of N and n bases, ignored if only headers are parsed
+    double max_n_fraction;
+};
+
+/*!
+ * @brief Predicates evaluated by MHAP, PAF and SAM parsers as soon as the
+ * columns they need are decoded, rejected records are neither constructed
+ * nor decoded further
+ */
+struct OverlapFilter {
+    OverlapFilter();
+
+    // longer of query and target spans (target span of the CIGAR for SAM)
+    std::uint32_t min_length;
+    // matching bases per alignment block length for PAF, 1 - error for MHAP
+    double min_identity;
+    // PAF and SAM
+    std::uint32_t min_mapping_quality;
+    // SAM records with any of these bits set (e.g. 0x904 for unmapped,
+    // secondary and supplementary) are rejected
+    std::uint32_t excluded_flags;
+    // MHAP and PAF overlaps of a read with itself
+    bool remove_self_overlaps;
+};
+
+/*!
+ * @brief Limits of each batch in addition to max_bytes (0 for none), a batch
+ * ends right after the record which reaches one of them and the rest of the
+ * input block is kept in memory for the next call instead of seeking back
+ */
+struct BatchLimits {
+    BatchLimits();
+
+    // constructed records
+    std::uint64_t max_records;
+    // sequence lengths of constructed records (query spans for MHAP and PAF,
+    // interval lengths for BED, segment lengths for GFA)
+    std::uint64_t max_bases;
+    // estimated memory of objects stored in dst, each costs its unique_ptr
+    // and either T::size_in_bytes() if T has it or sizeof(T) plus the
+    // lengths of strings passed to its constructor
+    std::uint64_t max_memory;
+};
+
+/*!
+ * @brief Thread safe table of names with ids given in order of insertion,
+ * shareable between parsers and seedable with read names beforehand so that
+ * ids match read indices
+ */
+class NameTable {
+public:
+    NameTable();
+
+    std::uint32_t size() const;
+    const std::string& name(std::uint32_t id) const;
+
+    // returns -1 for unknown names
+    std::uint32_t id(const char* name, std::uint32_t name_length) const;
+    std::uint32_t id(const std::string& name) const;
+
+    // returns the id of name, which is added if missing
+    std::uint32_t intern(const char* name, std::uint32_t name_length);
+    std::uint32_t intern(const std::string& name);
+    // interns both names under one lock (e.g. query and target of a record)
+    void intern(const char* first, std::uint32_t first_length,
+        const char* second, std::uint32_t second_length,
+        std::uint32_t& first_id, std::uint32_t& second_id);
+
+private:
+    // open addressing with linear probing, lookups do not allocate
+    std::uint64_t slot(const char* name, std::uint32_t name_length) const;
+    void grow();
+    // intern without taking the lock
+    std::uint32_t insert(const char* name, std::uint32_t name_length);
+
+    // references stay valid while names are added
+    std::deque<std::string> names_;
+    // ids + 1, 0 marks an empty slot
+    std::vector<std::uint32_t> slots_;
+    mutable std::mutex mutex_;
+};
+
+/*!
+ * @brief Compressed overlaps filled by MHAP and PAF parsers, sorted by query
+ * id and then by target id and query begin; overlaps of each query are
+ * delta and varint encoded into one block, so that a query is accessed
+ * directly and decoded sequentially (overlaps parsed in chunks are merged
+ * in bulk, all of them are present once the parser returns false)
+ */
+class OverlapStore {
+public:
+    // MHAP overlaps have block_length set to the longer span,
+    // matching_bases to (1 - error) * block_length and mapping_quality to 255
+    struct Record {
+        std::uint32_t q_id;
+        std::uint32_t q_length;
+        std::uint32_t q_begin;
+        std::uint32_t q_end;
+        char orientation;
+        std::uint32_t t_id;
+        std::uint32_t t_length;
+        std::uint32_t t_begin;
+        std::uint32_t t_end;
+        std::uint32_t matching_bases;
+        std::uint32_t block_length;
+        std::uint32_t mapping_quality;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Record;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Record*;
+        using reference = const Record&;
+
+        const Record& operator*() const;
+        const Record* operator->() const;
+        Iterator& operator++();
+
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        friend class OverlapStore;
+
+        Iterator(const OverlapStore* store, std::uint32_t q_id,
+            std::uint64_t begin, std::uint64_t end);
+
+        void decode();
+
+        const OverlapStore* store_;
+        std::uint64_t begin_;
+        std::uint64_t next_;
+        std::uint64_t end_;
+        Record record_;
+    };
+
+    OverlapStore();
+
+    // number of overlaps
+    std::uint64_t size() const;
+    // one more than the largest query id
+    std::uint32_t num_queries() const;
+    // encoded overlaps, the query index and overlaps pending a merge
+    std::uint64_t size_in_bytes() const;
+
+    // names of PAF overlaps, nullptr for MHAP overlaps
+    const std::shared_ptr<NameTable>& names() const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    // overlaps with the given query, empty for unknown ids
+    Iterator begin(std::uint32_t q_id) const;
+    Iterator end(std::uint32_t q_id) const;
+
+private:
+    template<class T>
+    friend class MhapParser;
+    template<class T>
+    friend class PafParser;
+
+    void add(const Record& record);
+    // merges pending overlaps into the encoded blocks at the end of the input
+    // or once they take as much memory as the blocks, so that blocks are
+    // rewritten a logarithmic number of times instead of once per chunk
+    void merge(bool is_last);
+
+    // record is encoded relative to prev, which is reset at each query
+    static void encode(const Record& prev, const Record& record,
+        std::vector<std::uint8_t>& dst);
+    static void decode(const std::uint8_t*& src, Record& record);
+
+    std::vector<std::uint8_t> data_;
+    // block of query i is [offsets_[i], offsets_[i + 1])
+    std::vector<std::uint64_t> offsets_;
+    std::uint64_t size_;
+    std::vector<Record> new_records_;
+    std::shared_ptr<NameTable> names_;
+};
+
 /*!
  * @brief Parser definitions
  */
@@ -64,7 +612,7 @@ class Parser {
 public:
     virtual ~Parser() = 0;
 
-    void reset();
+    virtual void reset();
 
     virtual bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) = 0;
@@ -72,241 +620,4963 @@ public:
     bool parse(std::vector<std::shared_ptr<T>>& dst, std::uint64_t max_bytes,
         bool trim = true);
 
+    /*!
+     * @brief Stores parsed records into <path>.bpc once the whole input is
+     * parsed and maps them from there on later opens (has to be called before
+     * the first parse, supported by FASTA, FASTQ, MHAP and PAF parsers; trim
+     * may only change after reset)
+     */
+    void enable_cache();
+
+    // applies to all following batches, see BatchLimits
+    void set_limits(const BatchLimits& limits);
+
 protected:
     Parser(gzFile input_file, std::uint32_t storage_size);
     Parser(const Parser&) = delete;
     const Parser& operator=(const Parser&) = delete;
 
+    template<template<class> class P, class U>
+    friend class MultiParser;
+
+    // returns true if records are read from a valid cache
+    bool open_cache(const std::string& format);
+
+    // reads the next block into buffer_, bytes kept by keep_block go first
+    std::uint64_t read_block();
+    // keeps buffer_[begin, end) for the next read_block, returns false if
+    // nothing is left to parse
+    bool keep_block(std::uint64_t begin, std::uint64_t end);
+    // true if the input is exhausted, kept bytes included
+    bool is_eof() const;
+    // decompressed offset of the next byte to parse
+    std::uint64_t tell() const;
+
+    // counts constructed records and their bases towards limits_, objects
+    // stored in dst are counted with their memory as well
+    void open_batch();
+    void count(std::uint64_t num_bases);
+    void count(std::uint64_t num_bases, const T& object,
+        std::uint64_t num_bytes);
+    bool is_batch_full() const;
+
     std::unique_ptr<gzFile_s, int(*)(gzFile)> input_file_;
     std::vector<char> buffer_;
     std::vector<char> storage_;
+    std::string path_;
+    bool is_cache_enabled_;
+    std::unique_ptr<ParserCache> cache_;
+    BatchLimits limits_;
+    std::uint64_t num_records_;
+    std::uint64_t num_bases_;
+    std::uint64_t memory_size_;
+    std::uint64_t block_begin_;
+    std::uint64_t block_end_;
+
+private:
+    template<class U>
+    static auto hasSizeInBytes(int) -> decltype(
+        std::declval<const U&>().size_in_bytes(), std::true_type());
+
+    template<class U>
+    static std::false_type hasSizeInBytes(...);
+
+    static std::uint64_t objectSize(std::true_type, const T& object,
+        std::uint64_t num_bytes);
+    static std::uint64_t objectSize(std::false_type, const T& object,
+        std::uint64_t num_bytes);
 };
 
 template<class T>
-class FastaParser: public Parser<T> {
+class FastaParser final: public Parser<T> {
 public:
     ~FastaParser();
 
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    // parse with compile time options, see StaticParser
+    template<class O>
+    bool parse(std::vector<std::unique_ptr<T>>& dst, std::uint64_t max_bytes);
+
+    // has to be called before the first parse, disables the cache
+    void set_filter(const ReadFilter& filter);
+
+    /*!
+     * @brief Streams records without storing whole sequences, header is
+     * called with the name of each record and chunk with successive pieces
+     * of its sequence (const char*, std::uint32_t, bool is_last) of at most
+     * kMSS bytes, the last one possibly empty; stops at the first record
+     * boundary after max_bytes
+     */
+    template<class H, class C>
+    bool stream(std::uint64_t max_bytes, H header, C chunk, bool trim = true);
+
+    // true if T has the constructor required by this parser (with the
+    // sequence or with its length only)
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value ||
+            decltype(hasHeaderConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<FastaParser<T>>
         createParser<bioparser::FastaParser, T>(const std::string& path);
 
 private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    // name and sequence length only, sequence bytes are skipped
+    // without being copied if T has this constructor and not the one above
+    template<class U>
+    static auto hasHeaderConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasHeaderConstructor(...);
+
+    static constexpr bool isHeaderOnly() {
+        return !decltype(hasConstructor<T>(0))::value &&
+            decltype(hasHeaderConstructor<T>(0))::value;
+    }
+
+    T* createT(std::false_type, const char* name, std::uint32_t name_length,
+        const char* sequence, std::uint32_t sequence_length);
+    T* createT(std::true_type, const char* name, std::uint32_t name_length,
+        const char* sequence, std::uint32_t sequence_length);
+
     FastaParser(gzFile input_file);
     FastaParser(const FastaParser&) = delete;
     const FastaParser& operator=(const FastaParser&) = delete;
+
+    // sequences are copied a line at once if the file is not wrapped
+    bool is_single_line_;
+    ReadFilter filter_;
+    bool is_filtered_;
 };
 
 template<class T>
-class FastqParser: public Parser<T> {
+class FastqParser final: public Parser<T> {
 public:
     ~FastqParser();
 
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    // parse with compile time options, see StaticParser
+    template<class O>
+    bool parse(std::vector<std::unique_ptr<T>>& dst, std::uint64_t max_bytes);
+
+    // has to be called before the first parse, disables the cache
+    void set_filter(const ReadFilter& filter);
+
+    // true if T has the constructor required by this parser (with qualities,
+    // without them or with the sequence length only)
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value ||
+            decltype(hasSequenceConstructor<T>(0))::value ||
+            decltype(hasHeaderConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<FastqParser<T>>
         createParser<bioparser::FastqParser, T>(const std::string& path);
 
 private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    // constructor of FastaParser, qualities are counted and never copied if
+    // T has this constructor and not the one above
+    template<class U>
+    static auto hasSequenceConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasSequenceConstructor(...);
+
+    // name and sequence length only, sequence bytes and qualities are skipped
+    // without being copied if T has this constructor and none of the above
+    template<class U>
+    static auto hasHeaderConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasHeaderConstructor(...);
+
+    // 0 with qualities, 1 without them, 2 with the sequence length only
+    static constexpr int signature() {
+        return decltype(hasConstructor<T>(0))::value ? 0 :
+            (decltype(hasSequenceConstructor<T>(0))::value ? 1 : 2);
+    }
+
+    static constexpr bool isHeaderOnly() {
+        return signature() == 2;
+    }
+
+    T* createT(std::integral_constant<int, 0>, const char* name,
+        std::uint32_t name_length, const char* sequence,
+        std::uint32_t sequence_length, const char* quality,
+        std::uint32_t quality_length);
+    T* createT(std::integral_constant<int, 1>, const char* name,
+        std::uint32_t name_length, const char* sequence,
+        std::uint32_t sequence_length, const char* quality,
+        std::uint32_t quality_length);
+    T* createT(std::integral_constant<int, 2>, const char* name,
+        std::uint32_t name_length, const char* sequence,
+        std::uint32_t sequence_length, const char* quality,
+        std::uint32_t quality_length);
+
     FastqParser(gzFile input_file);
     FastqParser(const FastqParser&) = delete;
     const FastqParser& operator=(const FastqParser&) = delete;
+
+    ReadFilter filter_;
+    bool is_filtered_;
 };
 
+KSEQ_INIT(gzFile, gzread)
+
 template<class T>
-class HLFastqParser: public Parser<T> {
+class HLFastqParser final: public Parser<T> {
 public:
     ~HLFastqParser();
 
+    void reset() override;
+
+    // reads the whole file unless limited by set_limits
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    friend std::unique_ptr<HLFastqParser<T>>
         createParser<bioparser::HLFastqParser, T>(const std::string& path);
 
 private:
     HLFastqParser(gzFile input_file);
     HLFastqParser(const HLFastqParser&) = delete;
     const HLFastqParser& operator=(const HLFastqParser&) = delete;
+
+    // kept between calls together with its buffer
+    std::unique_ptr<kseq_t, void(*)(kseq_t*)> seq_;
 };
 
 
 template<class T>
-class MhapParser: public Parser<T> {
+class MhapParser final: public Parser<T> {
 public:
     ~MhapParser();
 
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    /*!
+     * @brief Appends overlaps to dst instead of constructing objects, all
+     * columns are decoded regardless of the projection and the cache is not
+     * used
+     */
+    bool parse(OverlapStore& dst, std::uint64_t max_bytes);
+
+    // has to be called before the first parse, disables the cache
+    void set_filter(const OverlapFilter& filter);
+
+    /*!
+     * @brief Decodes only the given 0-based columns, others are passed as 0
+     * or as empty strings without being converted or stripped (columns the
+     * filter needs are decoded regardless), has to be called before the
+     * first parse and disables the cache
+     */
+    void set_projection(std::initializer_list<std::uint32_t> columns);
+
+    // true if T has the constructor required by this parser
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<MhapParser<T>>
         createParser<bioparser::MhapParser, T>(const std::string& path);
 
 private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<std::uint64_t>(), std::declval<std::uint64_t>(),
+        std::declval<double>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
     MhapParser(gzFile input_file);
     MhapParser(const MhapParser&) = delete;
     const MhapParser& operator=(const MhapParser&) = delete;
+
+    // splits lines into the given columns and passes them to create
+    template<class F>
+    bool parse_lines(std::uint64_t max_bytes, std::uint32_t columns, F create);
+
+    OverlapFilter filter_;
+    bool is_filtered_;
+    std::uint32_t projection_;
 };
 
 template<class T>
-class PafParser: public Parser<T> {
+class PafParser final: public Parser<T> {
 public:
     ~PafParser();
 
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    /*!
+     * @brief Appends overlaps to dst instead of constructing objects, all
+     * columns are decoded regardless of the projection and the cache is not
+     * used
+     */
+    bool parse(OverlapStore& dst, std::uint64_t max_bytes, bool trim = true);
+
+    // table used to intern read names if T takes ids, can be shared between
+    // parsers or seeded with read names before the first parse
+    const std::shared_ptr<NameTable>& names() const;
+    void set_names(std::shared_ptr<NameTable> names);
+
+    // has to be called before the first parse, disables the cache
+    void set_filter(const OverlapFilter& filter);
+
+    /*!
+     * @brief Decodes only the given 0-based columns, others are passed as 0
+     * or as empty strings without being converted or stripped (columns the
+     * filter needs and names of T taking ids are decoded regardless), has to
+     * be called before the first parse and disables the cache
+     */
+    void set_projection(std::initializer_list<std::uint32_t> columns);
+
+    // true if T has the constructor required by this parser (with read
+    // names, with read names and optional columns or with read ids)
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value ||
+            decltype(hasTagsConstructor<T>(0))::value ||
+            decltype(hasIdConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<PafParser<T>>
         createParser<bioparser::PafParser, T>(const std::string& path);
 
 private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<char>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    // optional columns are passed as one tab separated string (empty if
+    // there are none), this constructor is preferred if T has both
+    template<class U>
+    static auto hasTagsConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<char>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasTagsConstructor(...);
+
+    // converts only to V (or a reference to it), so that parameters of
+    // other types do not match through implicit conversions
+    template<class V>
+    struct Exactly {
+        template<class U, class = typename std::enable_if<
+            std::is_same<U, V>::value>::type>
+        operator U() const;
+    };
+
+    // names are replaced with their ids in names() if T has a constructor
+    // with exactly these parameter types and no constructor with names (MHAP
+    // constructors with 64-bit ids and a double error would otherwise match
+    // through conversions)
+    template<class U>
+    static auto hasIdConstructor(int) -> decltype(U(
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<char>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>(),
+        std::declval<Exactly<std::uint32_t>>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasIdConstructor(...);
+
+    static constexpr bool usesIds() {
+        return !decltype(hasConstructor<T>(0))::value &&
+            !decltype(hasTagsConstructor<T>(0))::value &&
+            decltype(hasIdConstructor<T>(0))::value;
+    }
+
+    static constexpr bool usesTags() {
+        return decltype(hasTagsConstructor<T>(0))::value;
+    }
+
     PafParser(gzFile input_file);
     PafParser(const PafParser&) = delete;
     const PafParser& operator=(const PafParser&) = delete;
+
+    // splits lines into the given columns and passes them to create together
+    // with the optional columns
+    template<class F>
+    bool parse_lines(std::uint64_t max_bytes, bool trim, std::uint32_t columns,
+        F create);
+
+    // passes either names (and optional columns if T takes them) or their
+    // interned ids
+    T* createT(std::false_type, const char* q_name,
+        std::uint32_t q_name_length, std::uint32_t q_length,
+        std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+        const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_length, std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char* tags,
+        std::uint32_t tags_length);
+    T* createT(std::true_type, const char* q_name,
+        std::uint32_t q_name_length, std::uint32_t q_length,
+        std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+        const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_length, std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char* tags,
+        std::uint32_t tags_length);
+
+    template<class... Args>
+    static T* construct(std::true_type, const char* tags,
+        std::uint32_t tags_length, Args... args);
+    template<class... Args>
+    static T* construct(std::false_type, const char*, std::uint32_t,
+        Args... args);
+
+    mutable std::shared_ptr<NameTable> names_;
+    OverlapFilter filter_;
+    bool is_filtered_;
+    std::uint32_t projection_;
 };
 
 template<class T>
-class SamParser: public Parser<T> {
+class SamParser final: public Parser<T> {
 public:
     ~SamParser();
 
+    void reset() override;
+
     bool parse(std::vector<std::unique_ptr<T>>& dst,
         std::uint64_t max_bytes, bool trim = true) override;
 
-    friend std::unique_ptr<Parser<T>>
+    // references of @SQ lines read so far
+    const SamHeader& header() const;
+
+    void set_filter(const OverlapFilter& filter);
+
+    /*!
+     * @brief Decodes only the given 0-based columns, others are passed as 0
+     * or as empty strings without being converted or stripped (columns the
+     * filter or a decoded CIGAR need are decoded regardless), has to be
+     * called before the first parse
+     */
+    void set_projection(std::initializer_list<std::uint32_t> columns);
+
+    // true if T has the constructor required by this parser (with reference
+    // names or with reference ids), optionally followed by the decoded CIGAR
+    // and/or the optional fields
+    static constexpr bool is_supported() {
+        return usesNames() || usesIds();
+    }
+
+    friend std::unique_ptr<SamParser<T>>
         createParser<bioparser::SamParser, T>(const std::string& path);
 
 private:
+    // decoded CIGAR is passed as a trailing const SamCigar& and optional
+    // fields as a trailing const SamTags& if T has a matching constructor,
+    // the CIGAR is decoded only in that case
+    template<class U, class... Extra>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<Extra>()...),
+        std::true_type());
+
+    template<class U, class... Extra>
+    static std::false_type hasConstructor(...);
+
+    // reference names are replaced with their ids from header() (-1 for '*')
+    // if T has a matching constructor, which is preferred over names
+    template<class U, class... Extra>
+    static auto hasIdConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<Extra>()...),
+        std::true_type());
+
+    template<class U, class... Extra>
+    static std::false_type hasIdConstructor(...);
+
+    static constexpr bool usesNames() {
+        return decltype(hasConstructor<T>(0))::value ||
+            decltype(hasConstructor<T, const SamTags&>(0))::value ||
+            decltype(hasConstructor<T, const SamCigar&>(0))::value ||
+            decltype(hasConstructor<T, const SamCigar&,
+                const SamTags&>(0))::value;
+    }
+
+    static constexpr bool usesIds() {
+        return decltype(hasIdConstructor<T>(0))::value ||
+            decltype(hasIdConstructor<T, const SamTags&>(0))::value ||
+            decltype(hasIdConstructor<T, const SamCigar&>(0))::value ||
+            decltype(hasIdConstructor<T, const SamCigar&,
+                const SamTags&>(0))::value;
+    }
+
+    // 0 - plain, 1 - with tags, 2 - with CIGAR, 3 - with CIGAR and tags
+    static constexpr int signature() {
+        return usesIds() ?
+            (decltype(hasIdConstructor<T, const SamCigar&,
+                const SamTags&>(0))::value ? 3 :
+            decltype(hasIdConstructor<T, const SamCigar&>(0))::value ? 2 :
+            decltype(hasIdConstructor<T, const SamTags&>(0))::value ? 1 : 0) :
+            (decltype(hasConstructor<T, const SamCigar&,
+                const SamTags&>(0))::value ? 3 :
+            decltype(hasConstructor<T, const SamCigar&>(0))::value ? 2 :
+            decltype(hasConstructor<T, const SamTags&>(0))::value ? 1 : 0);
+    }
+
     SamParser(gzFile input_file);
     SamParser(const SamParser&) = delete;
     const SamParser& operator=(const SamParser&) = delete;
+
+    template<class... Args>
+    T* createT(std::integral_constant<int, 0>, Args... args);
+    template<class... Args>
+    T* createT(std::integral_constant<int, 1>, Args... args);
+    template<class... Args>
+    T* createT(std::integral_constant<int, 2>, Args... args);
+    template<class... Args>
+    T* createT(std::integral_constant<int, 3>, Args... args);
+
+    // drops either reference names or reference ids
+    T* createT(std::false_type, const char* q_name,
+        std::uint32_t q_name_length, std::uint32_t flag, const char* t_name,
+        std::uint32_t t_name_length, std::uint32_t t_id, std::uint32_t t_begin,
+        std::uint32_t mapping_quality, const char* cigar,
+        std::uint32_t cigar_length, const char* t_next_name,
+        std::uint32_t t_next_name_length, std::uint32_t t_next_id,
+        std::uint32_t t_next_begin, std::uint32_t template_length,
+        const char* sequence, std::uint32_t sequence_length,
+        const char* quality, std::uint32_t quality_length);
+    T* createT(std::true_type, const char* q_name,
+        std::uint32_t q_name_length, std::uint32_t flag, const char* t_name,
+        std::uint32_t t_name_length, std::uint32_t t_id, std::uint32_t t_begin,
+        std::uint32_t mapping_quality, const char* cigar,
+        std::uint32_t cigar_length, const char* t_next_name,
+        std::uint32_t t_next_name_length, std::uint32_t t_next_id,
+        std::uint32_t t_next_begin, std::uint32_t template_length,
+        const char* sequence, std::uint32_t sequence_length,
+        const char* quality, std::uint32_t quality_length);
+
+    SamTags tags_;
+    SamCigar cigar_;
+    SamHeader header_;
+    OverlapFilter filter_;
+    bool is_filtered_;
+    std::uint32_t projection_;
 };
 
-/*!
- * @brief Implementation
- */
-inline void rightStrip(const char* src, std::uint32_t& src_length) {
-    while (src_length > 0 && isspace(src[src_length - 1])) {
-        --src_length;
-    }
-}
+template<class T>
+class BamParser final: public Parser<T> {
+public:
+    ~BamParser();
 
-inline void rightStripHard(const char* src, std::uint32_t& src_length) {
-    for (std::uint32_t i = 0; i < src_length; ++i) {
-        if (isspace(src[i])) {
-            src_length = i;
-            break;
-        }
-    }
-}
+    void reset() override;
 
-template<template<class> class P, class T>
-inline std::unique_ptr<Parser<T>> createParser(const std::string& path) {
+    bool parse(std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes, bool trim = true) override;
 
-    auto input_file = gzopen(path.c_str(), "r");
-    if (input_file == nullptr) {
-        throw std::invalid_argument("[bioparser::createParser] error: "
-            "unable to open file " + path + "!");
+    // references of the binary header, available after the first parse
+    const SamHeader& header() const;
+
+    // true if T has the constructor required by this parser
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value;
     }
 
-    return std::unique_ptr<Parser<T>>(new P<T>(input_file));
-}
+    friend std::unique_ptr<BamParser<T>>
+        createParser<bioparser::BamParser, T>(const std::string& path);
 
-template<class T>
-inline Parser<T>::Parser(gzFile input_file, std::uint32_t storage_size)
-        : input_file_(input_file, gzclose), buffer_(kBufferSize, 0),
-        storage_(storage_size, 0) {
-}
+private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    BamParser(std::FILE* input_file);
+    BamParser(const BamParser&) = delete;
+    const BamParser& operator=(const BamParser&) = delete;
+
+    // inflates up to kBgzfBatchSize BGZF blocks in parallel into data_
+    bool inflate_blocks();
+    // makes sure that num_bytes of decompressed data are available
+    bool fill(std::uint64_t num_bytes);
+    void parse_header();
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> bam_file_;
+    std::uint32_t num_threads_;
+    bool is_eof_;
+    bool is_header_parsed_;
+    std::vector<char> blocks_;
+    std::vector<char> data_;
+    std::uint64_t data_begin_;
+    SamHeader header_;
+};
 
 template<class T>
-inline Parser<T>::~Parser() {
-}
+class GfaParser final: public Parser<T> {
+public:
+    ~GfaParser();
 
-template<class T>
-inline void Parser<T>::reset() {
-    gzseek(this->input_file_.get(), 0, SEEK_SET);
-}
+    void reset() override;
 
-template<class T>
-inline bool Parser<T>::parse(std::vector<std::shared_ptr<T>>& dst,
-    std::uint64_t max_bytes, bool trim) {
+    bool parse(std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes, bool trim = true) override;
 
-    std::vector<std::unique_ptr<T>> tmp;
-    auto ret = this->parse_objects(tmp, max_bytes, trim);
+    /*!
+     * @brief Segments are passed with empty sequences whose bytes are
+     * skipped without copying (topology only)
+     */
+    void set_skip_sequences(bool skip_sequences);
 
-    dst.reserve(dst.size() + tmp.size());
-    for (auto& it: tmp) {
-        dst.emplace_back(std::move(it));
+    // true if T has the constructors of segments and links
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value;
     }
-    return ret;
-}
 
-template<class T>
-inline FastaParser<T>::FastaParser(gzFile input_file)
-        : Parser<T>(input_file, kSSS + kMSS) {
-}
+    friend std::unique_ptr<GfaParser<T>>
+        createParser<bioparser::GfaParser, T>(const std::string& path);
 
-template<class T>
-inline FastaParser<T>::~FastaParser() {
-}
+private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        U(std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<char>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<char>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    GfaParser(gzFile input_file);
+    GfaParser(const GfaParser&) = delete;
+    const GfaParser& operator=(const GfaParser&) = delete;
+
+    // P and E lines are passed only if T has a matching constructor
+    template<class U>
+    static auto hasPathConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasPathConstructor(...);
+
+    template<class U>
+    static auto hasEdgeConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<char>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<char>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasEdgeConstructor(...);
+
+    void createPath(std::vector<std::unique_ptr<T>>& dst,
+        const char** values, const std::uint32_t* lengths, std::true_type);
+    void createPath(std::vector<std::unique_ptr<T>>&,
+        const char**, const std::uint32_t*, std::false_type) {}
+
+    void createEdge(std::vector<std::unique_ptr<T>>& dst,
+        const char** values, const std::uint32_t* lengths, std::true_type);
+    void createEdge(std::vector<std::unique_ptr<T>>&,
+        const char**, const std::uint32_t*, std::false_type) {}
+
+    bool skip_sequences_;
+    bool is_gfa2_;
+};
 
 template<class T>
-inline bool FastaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+class TwoBitParser final: public Parser<T> {
+public:
+    ~TwoBitParser();
+
+    void reset() override;
+
+    bool parse(std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes, bool trim = true) override;
+
+    /*!
+     * @brief Sequence names in file order
+     */
+    const std::vector<std::string>& sequence_names();
+
+    std::uint32_t sequence_length(const std::string& name);
+
+    /*!
+     * @brief Returns bases [begin, end) of a sequence read directly from its
+     * offset, N blocks as 'N' and masked blocks in lowercase
+     */
+    std::string fetch(const std::string& name, std::uint32_t begin,
+        std::uint32_t end);
+
+    // true if T has the constructor required by this parser
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<TwoBitParser<T>>
+        createParser<bioparser::TwoBitParser, T>(const std::string& path);
+
+private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    TwoBitParser(std::FILE* input_file);
+    TwoBitParser(const TwoBitParser&) = delete;
+    const TwoBitParser& operator=(const TwoBitParser&) = delete;
+
+    // blocks are stored as all starts followed by all ends
+    struct Record {
+        std::uint32_t length;
+        std::uint64_t packed_offset;
+        std::vector<std::uint32_t> n_blocks;
+        std::vector<std::uint32_t> mask_blocks;
+    };
+
+    std::uint32_t read32();
+    void parse_index();
+    // reads length, N blocks and mask blocks of a sequence once
+    const Record& parse_record(std::uint32_t id);
+    // writes bases [begin, end) of a sequence to dst
+    void unpack(const Record& record, std::uint32_t begin, std::uint32_t end,
+        char* dst);
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> two_bit_file_;
+    bool is_swapped_;
+    bool is_index_parsed_;
+    std::vector<std::string> names_;
+    std::vector<std::uint64_t> offsets_;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    std::uint32_t sequence_id_;
+    std::vector<std::unique_ptr<Record>> records_;
+    std::vector<std::uint8_t> packed_;
+};
+
+template<class T>
+class BedParser final: public Parser<T> {
+public:
+    ~BedParser();
+
+    bool parse(std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes, bool trim = true) override;
+
+    /*!
+     * @brief Appends intervals to dst instead of constructing objects, T's
+     * constructor is not needed in this mode
+     */
+    bool parse(BedIntervals& dst, std::uint64_t max_bytes);
+
+    // true if T has the constructor required by this parser
+    static constexpr bool is_supported() {
+        return decltype(hasConstructor<T>(0))::value;
+    }
+
+    friend std::unique_ptr<BedParser<T>>
+        createParser<bioparser::BedParser, T>(const std::string& path);
+
+private:
+    template<class U>
+    static auto hasConstructor(int) -> decltype(U(
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<std::uint32_t>(),
+        std::declval<const char*>(), std::declval<std::uint32_t>(),
+        std::declval<std::uint32_t>(), std::declval<char>()),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasConstructor(...);
+
+    BedParser(gzFile input_file);
+    BedParser(const BedParser&) = delete;
+    const BedParser& operator=(const BedParser&) = delete;
+
+    void createT(std::vector<std::unique_ptr<T>>& dst,
+        const char* chromosome, std::uint32_t chromosome_length,
+        std::uint32_t begin, std::uint32_t end, const char* name,
+        std::uint32_t name_length, std::uint32_t score, char strand,
+        std::true_type);
+    void createT(std::vector<std::unique_ptr<T>>&, const char*, std::uint32_t,
+        std::uint32_t, std::uint32_t, const char*, std::uint32_t,
+        std::uint32_t, char, std::false_type);
+
+    // splits lines into BED6 fields and passes them to create
+    template<class F>
+    bool parse_lines(std::uint64_t max_bytes, F create);
+};
+
+/*!
+ * @brief Presents files of the same format as one stream of records, the
+ * next file is opened and its first block decompressed in the background,
+ * batches continue across file boundaries (batches of binary formats end
+ * with each file)
+ */
+template<template<class> class P, class T>
+class MultiParser final: public Parser<T> {
+public:
+    ~MultiParser();
+
+    void reset() override;
+
+    bool parse(std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes, bool trim = true) override;
+
+    friend std::unique_ptr<MultiParser<P, T>> createParser<P, T>(
+        const std::vector<std::string>& paths);
+
+private:
+    MultiParser(const std::vector<std::string>& paths);
+    MultiParser(const MultiParser&) = delete;
+    const MultiParser& operator=(const MultiParser&) = delete;
+
+    // moves to the prefetched parser and starts prefetching the one after it
+    void open_next();
+    // decompressed bytes read from the current file, 0 for binary formats
+    std::uint64_t position() const;
+    // binary formats read their files without gzFile
+    bool is_binary() const;
+
+    std::vector<std::string> paths_;
+    std::uint32_t next_path_id_;
+    std::unique_ptr<P<T>> parser_;
+    std::future<std::unique_ptr<P<T>>> next_parser_;
+};
+
+/*!
+ * @brief Front end without virtual dispatch, calls are bound to P<T> at
+ * compile time so that the format loop and the construction of T can be
+ * inlined into the caller (format specific members are reached with ->);
+ * FASTA and FASTQ loops are compiled for options O, other formats only take
+ * the trim policy
+ */
+template<template<class> class P, class T, class O>
+class StaticParser {
+public:
+    explicit StaticParser(const std::string& path);
+
+    void reset();
+
+    bool parse(std::vector<std::unique_ptr<T>>& dst, std::uint64_t max_bytes);
+
+    P<T>* operator->();
+    const P<T>* operator->() const;
+
+private:
+    template<class U>
+    static auto hasOptions(int) -> decltype(std::declval<U&>().template
+        parse<O>(std::declval<std::vector<std::unique_ptr<T>>&>(), 0),
+        std::true_type());
+
+    template<class U>
+    static std::false_type hasOptions(...);
+
+    bool parse(std::true_type, std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes);
+    bool parse(std::false_type, std::vector<std::unique_ptr<T>>& dst,
+        std::uint64_t max_bytes);
+
+    std::unique_ptr<P<T>> parser_;
+};
+
+class Writer {
+public:
+    virtual ~Writer();
+
+    /*!
+     * @brief Sets the number of threads which compress independent blocks of
+     * buffered output (defaults to all hardware threads)
+     */
+    void set_num_threads(std::uint32_t num_threads);
+
+    // writes out all buffered records
+    void flush();
+
+protected:
+    Writer(std::FILE* output_file, bool is_compressed);
+    Writer(const Writer&) = delete;
+    const Writer& operator=(const Writer&) = delete;
+
+    void append(const char* src, std::uint32_t src_length);
+    void append(char c);
+    void append_unsigned(std::uint64_t value);
+    void append_signed(std::int64_t value);
+    // terminates a record and flushes the buffer once a batch is full
+    void end_record();
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> output_file_;
+    bool is_compressed_;
+    std::uint32_t num_threads_;
+    std::vector<char> buffer_;
+    std::uint64_t buffer_length_;
+};
+
+class PafWriter: public Writer {
+public:
+    ~PafWriter();
+
+    // takes the constructor arguments passed by PafParser
+    void write(const char* q_name, std::uint32_t q_name_length,
+        std::uint32_t q_length, std::uint32_t q_begin, std::uint32_t q_end,
+        char orientation, const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_length, std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char* tags = nullptr,
+        std::uint32_t tags_length = 0);
+
+    friend std::unique_ptr<PafWriter> createWriter<PafWriter>(
+        const std::string& path);
+
+private:
+    PafWriter(std::FILE* output_file, bool is_compressed);
+    PafWriter(const PafWriter&) = delete;
+    const PafWriter& operator=(const PafWriter&) = delete;
+};
+
+class SamWriter: public Writer {
+public:
+    ~SamWriter();
+
+    // header lines have to be written before the first alignment
+    void write_header(const char* header, std::uint32_t header_length);
+
+    // takes the constructor arguments passed by SamParser and BamParser
+    void write(const char* q_name, std::uint32_t q_name_length,
+        std::uint32_t flag, const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_begin, std::uint32_t mapping_quality,
+        const char* cigar, std::uint32_t cigar_length,
+        const char* t_next_name, std::uint32_t t_next_name_length,
+        std::uint32_t t_next_begin, std::uint32_t template_length,
+        const char* sequence, std::uint32_t sequence_length,
+        const char* quality, std::uint32_t quality_length);
+
+    friend std::unique_ptr<SamWriter> createWriter<SamWriter>(
+        const std::string& path);
+
+private:
+    SamWriter(std::FILE* output_file, bool is_compressed);
+    SamWriter(const SamWriter&) = delete;
+    const SamWriter& operator=(const SamWriter&) = delete;
+
+    // empty strings are written as '*'
+    void append_field(const char* src, std::uint32_t src_length);
+};
+
+class MhapWriter: public Writer {
+public:
+    ~MhapWriter();
+
+    // takes the constructor arguments passed by MhapParser
+    void write(std::uint64_t a_id, std::uint64_t b_id, double error,
+        std::uint32_t minmers, std::uint32_t a_rc, std::uint32_t a_begin,
+        std::uint32_t a_end, std::uint32_t a_length, std::uint32_t b_rc,
+        std::uint32_t b_begin, std::uint32_t b_end, std::uint32_t b_length);
+
+    friend std::unique_ptr<MhapWriter> createWriter<MhapWriter>(
+        const std::string& path);
+
+private:
+    MhapWriter(std::FILE* output_file, bool is_compressed);
+    MhapWriter(const MhapWriter&) = delete;
+    const MhapWriter& operator=(const MhapWriter&) = delete;
+};
+
+/*!
+ * @brief Options of sortOverlaps, input is parsed in batches of at most
+ * max_bytes (two batches are held in memory at once) which are sorted on
+ * num_threads threads and spilled gzip compressed into directory (next to
+ * the output file if empty)
+ */
+struct SortOptions {
+    SortOptions();
+
+    // sorts by target and then by query instead
+    bool by_target;
+    std::uint64_t max_bytes;
+    std::uint32_t num_threads;
+    std::string directory;
+};
+
+/*!
+ * @brief Sorts MhapParser or PafParser input by query (ids or names), target,
+ * query begin and target begin, and writes it with MhapWriter or PafWriter
+ * (PAF optional columns are kept as they are); sorted runs are merged in
+ * passes of bounded fan-in, ties keep their input order; output_path is
+ * replaced only once sorting succeeds
+ */
+template<template<class> class P>
+void sortOverlaps(const std::string& input_path, const std::string& output_path,
+    const SortOptions& options = SortOptions());
+
+/*!
+ * @brief Implementation
+ */
+inline void rightStrip(const char* src, std::uint32_t& src_length) {
+    while (src_length > 0 && isspace(src[src_length - 1])) {
+        --src_length;
+    }
+}
+
+inline void rightStripHard(const char* src, std::uint32_t& src_length) {
+    for (std::uint32_t i = 0; i < src_length; ++i) {
+        if (isspace(src[i])) {
+            src_length = i;
+            break;
+        }
+    }
+}
+
+inline std::uint16_t readLittleEndian16(const char* src) {
+    auto s = reinterpret_cast<const std::uint8_t*>(src);
+    return s[0] | (s[1] << 8);
+}
+
+inline std::uint32_t readLittleEndian32(const char* src) {
+    auto s = reinterpret_cast<const std::uint8_t*>(src);
+    return s[0] | (s[1] << 8) | (s[2] << 16) | ((std::uint32_t) s[3] << 24);
+}
+
+inline ParserCache::Record::Record(const std::vector<const char*>& columns,
+    const std::vector<const char*>& strings, std::uint64_t id)
+        : columns_(columns), strings_(strings), id_(id) {
+}
+
+inline const char* ParserCache::Record::string(std::uint32_t column) const {
+    std::uint64_t offset;
+    std::memcpy(&offset, columns_[column] + id_ * sizeof(offset),
+        sizeof(offset));
+    return strings_[column] + offset;
+}
+
+inline std::uint32_t ParserCache::Record::length(std::uint32_t column) const {
+    std::uint64_t offsets[2];
+    std::memcpy(offsets, columns_[column] + id_ * sizeof(offsets[0]),
+        sizeof(offsets));
+    return offsets[1] - offsets[0];
+}
+
+template<class U>
+inline U ParserCache::Record::value(std::uint32_t column) const {
+    U dst;
+    std::memcpy(&dst, columns_[column] + id_ * sizeof(U), sizeof(U));
+    return dst;
+}
+
+inline ParserCache::ParserCache(const std::string& path,
+    const std::string& format)
+        : path_(path + ".bpc"), format_(format), header_(),
+        cache_file_(nullptr, std::fclose),
+        columns_(), column_id_(0), num_records_(0), buffer_(),
+        data_(nullptr), data_length_(0), data_begin_(0), record_id_(0) {
+
+    struct stat input_stat;
+    if (stat(path.c_str(), &input_stat) != 0) {
+        return;
+    }
+
+    // seconds alone miss files rewritten to the same size within a second
+#if defined(__APPLE__)
+    std::uint64_t mtime_nsec = input_stat.st_mtimespec.tv_nsec;
+#elif defined(__unix__)
+    std::uint64_t mtime_nsec = input_stat.st_mtim.tv_nsec;
+#else
+    std::uint64_t mtime_nsec = 0;
+#endif
+    std::uint64_t key[5] = { (std::uint64_t) input_stat.st_size,
+        (std::uint64_t) input_stat.st_mtime, mtime_nsec,
+        (std::uint64_t) input_stat.st_ctime,
+        (std::uint64_t) input_stat.st_ino };
+    header_ = "BPC2" + format + '\0';
+    header_.append(reinterpret_cast<const char*>(key), sizeof(key));
+
+#if defined(BIOPARSER_USE_MMAP)
+    auto fd = open(path_.c_str(), O_RDONLY);
+    if (fd != -1) {
+        struct stat cache_stat;
+        if (fstat(fd, &cache_stat) == 0 &&
+            (std::uint64_t) cache_stat.st_size >= header_.size()) {
+
+            auto data = mmap(nullptr, cache_stat.st_size, PROT_READ,
+                MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                if (std::memcmp(data, header_.data(), header_.size()) == 0) {
+                    data_ = static_cast<const char*>(data);
+                    data_length_ = cache_stat.st_size;
+                    data_begin_ = header_.size();
+                } else {
+                    munmap(data, cache_stat.st_size);
+                }
+            }
+        }
+        close(fd);
+    }
+#else
+    struct stat cache_stat;
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> cache_file(
+        std::fopen(path_.c_str(), "rb"), std::fclose);
+    if (cache_file != nullptr && stat(path_.c_str(), &cache_stat) == 0 &&
+        (std::uint64_t) cache_stat.st_size >= header_.size()) {
+
+        buffer_.resize(cache_stat.st_size);
+        if (std::fread(buffer_.data(), 1, buffer_.size(), cache_file.get()) ==
+            buffer_.size() &&
+            std::memcmp(buffer_.data(), header_.data(), header_.size()) == 0) {
+
+            data_ = buffer_.data();
+            data_length_ = buffer_.size();
+            data_begin_ = header_.size();
+        } else {
+            std::vector<char>().swap(buffer_);
+        }
+    }
+#endif
+
+    if (data_ == nullptr) {
+        rewind();
+    }
+}
+
+inline ParserCache::~ParserCache() {
+#if defined(BIOPARSER_USE_MMAP)
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), data_length_);
+    }
+#endif
+    if (cache_file_ != nullptr) {
+        cache_file_.reset();
+        std::remove((path_ + ".tmp").c_str());
+    }
+}
+
+inline bool ParserCache::is_mapped() const {
+    return data_ != nullptr;
+}
+
+inline const std::string& ParserCache::format() const {
+    return format_;
+}
+
+inline void ParserCache::rewind() {
+    if (data_ != nullptr) {
+        data_begin_ = header_.size();
+        record_id_ = 0;
+        return;
+    }
+
+    // restart writing, a partially written cache is never used
+    columns_.clear();
+    num_records_ = 0;
+    cache_file_.reset(header_.empty() ? nullptr :
+        std::fopen((path_ + ".tmp").c_str(), "wb"));
+    if (cache_file_ != nullptr && std::fwrite(header_.data(), 1,
+        header_.size(), cache_file_.get()) != header_.size()) {
+
+        cache_file_.reset();
+    }
+}
+
+inline ParserCache::Column& ParserCache::column(std::uint8_t width) {
+    if (column_id_ == columns_.size()) {
+        columns_.emplace_back();
+        columns_.back().width = width;
+        if (width == 0) {
+            columns_.back().offsets.emplace_back(0);
+        }
+    }
+    return columns_[column_id_++];
+}
+
+template<class... Args>
+inline void ParserCache::store(Args... args) {
+    if (cache_file_ == nullptr) {
+        return;
+    }
+    column_id_ = 0;
+    store_values(args...);
+    ++num_records_;
+}
+
+template<class... Args>
+inline void ParserCache::store_values(const char* src,
+    std::uint32_t src_length, Args... args) {
+
+    auto& dst = column(0);
+    dst.data.insert(dst.data.end(), src, src + src_length);
+    dst.offsets.emplace_back(dst.data.size());
+    store_values(args...);
+}
+
+template<class U, class... Args>
+inline void ParserCache::store_values(U value, Args... args) {
+    auto& dst = column(sizeof(U));
+    auto src = reinterpret_cast<const char*>(&value);
+    dst.data.insert(dst.data.end(), src, src + sizeof(U));
+    store_values(args...);
+}
+
+inline void ParserCache::flush(bool is_last) {
+    if (cache_file_ == nullptr) {
+        return;
+    }
+
+    // block: records, columns, then per column width, size and data
+    auto file = cache_file_.get();
+    std::uint64_t num_columns = columns_.size();
+    bool is_valid =
+        std::fwrite(&num_records_, sizeof(num_records_), 1, file) == 1 &&
+        std::fwrite(&num_columns, sizeof(num_columns), 1, file) == 1;
+    for (const auto& it: columns_) {
+        std::uint64_t offsets_size = it.offsets.size() * sizeof(std::uint64_t);
+        std::uint64_t size = offsets_size + it.data.size();
+        is_valid = is_valid &&
+            std::fwrite(&it.width, sizeof(it.width), 1, file) == 1 &&
+            std::fwrite(&size, sizeof(size), 1, file) == 1 &&
+            // empty vectors may have no data to pass to fwrite
+            (offsets_size == 0 || std::fwrite(it.offsets.data(), 1,
+                offsets_size, file) == offsets_size) &&
+            (it.data.empty() || std::fwrite(it.data.data(), 1,
+                it.data.size(), file) == it.data.size());
+    }
+    columns_.clear();
+    num_records_ = 0;
+
+    if (!is_valid) {
+        cache_file_.reset();
+        std::remove((path_ + ".tmp").c_str());
+        return;
+    }
+
+    if (is_last) {
+        is_valid = std::fclose(cache_file_.release()) == 0 &&
+            std::rename((path_ + ".tmp").c_str(), path_.c_str()) == 0;
+        if (!is_valid) {
+            std::remove((path_ + ".tmp").c_str());
+        }
+    }
+}
+
+template<class F>
+inline bool ParserCache::load(std::uint64_t max_bytes, F create) {
+
+    std::uint64_t total_bytes = 0;
+    std::vector<const char*> columns;
+    std::vector<const char*> strings;
+    std::vector<std::uint8_t> widths;
+
+    auto is_valid = [&] (std::uint64_t length) -> void {
+        if (data_begin_ + length > data_length_) {
+            throw std::invalid_argument("[bioparser::ParserCache] error: "
+                "invalid cache " + path_ + "!");
+        }
+    };
+
+    while (data_begin_ < data_length_) {
+        std::uint64_t num_records, num_columns;
+        auto block = data_ + data_begin_;
+        is_valid(16);
+        std::memcpy(&num_records, block, sizeof(num_records));
+        std::memcpy(&num_columns, block + 8, sizeof(num_columns));
+
+        columns.clear();
+        strings.clear();
+        widths.clear();
+        std::uint64_t block_length = 16;
+        for (std::uint64_t i = 0; i < num_columns; ++i) {
+            std::uint64_t size;
+            is_valid(block_length + 9);
+            widths.emplace_back(block[block_length]);
+            std::memcpy(&size, block + block_length + 1, sizeof(size));
+            columns.emplace_back(block + block_length + 9);
+            strings.emplace_back(
+                columns.back() + (num_records + 1) * sizeof(size));
+            block_length += 9 + size;
+        }
+        is_valid(block_length);
+
+        for (; record_id_ < num_records; ++record_id_) {
+            ParserCache::Record record(columns, strings, record_id_);
+
+            std::uint64_t record_bytes = 0;
+            for (std::uint32_t i = 0; i < num_columns; ++i) {
+                record_bytes += widths[i] == 0 ? record.length(i) : widths[i];
+            }
+            if (max_bytes != 0 && total_bytes != 0 &&
+                total_bytes + record_bytes > max_bytes) {
+                return true;
+            }
+            total_bytes += record_bytes;
+
+            if (create(record)) {
+                ++record_id_;
+                return record_id_ < num_records ||
+                    data_begin_ + block_length < data_length_;
+            }
+        }
+
+        data_begin_ += block_length;
+        record_id_ = 0;
+    }
+
+    return false;
+}
+
+inline SamTags::SamTags()
+        : data_(nullptr), data_length_(0), is_indexed_(false), offsets_() {
+}
+
+inline void SamTags::reset(const char* data, std::uint32_t data_length) {
+    data_ = data;
+    data_length_ = data_length;
+    is_indexed_ = false;
+}
+
+inline const char* SamTags::data() const {
+    return data_;
+}
+
+inline std::uint32_t SamTags::length() const {
+    return data_length_;
+}
+
+inline void SamTags::index() const {
+    if (is_indexed_) {
+        return;
+    }
+    offsets_.clear();
+    for (std::uint32_t begin = 0; begin < data_length_;) {
+        offsets_.emplace_back(begin);
+        auto end = static_cast<const char*>(std::memchr(&data_[begin], '\t',
+            data_length_ - begin));
+        begin = end == nullptr ? data_length_ : end - data_ + 1;
+    }
+    offsets_.emplace_back(data_length_ + 1);
+    is_indexed_ = true;
+}
+
+inline std::uint32_t SamTags::size() const {
+    index();
+    return offsets_.size() - 1;
+}
+
+inline bool SamTags::find(const char* tag, char& type, const char*& value,
+    std::uint32_t& value_length) const {
+
+    index();
+    for (std::uint32_t i = 0; i + 1 < offsets_.size(); ++i) {
+        const char* field = &data_[offsets_[i]];
+        std::uint32_t field_length = offsets_[i + 1] - offsets_[i] - 1;
+        if (field_length >= 5 && field[0] == tag[0] && field[1] == tag[1] &&
+            field[2] == ':' && field[4] == ':') {
+            type = field[3];
+            value = &field[5];
+            value_length = field_length - 5;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool SamTags::find(const char* tag, std::int64_t& value) const {
+    char type;
+    const char* src;
+    std::uint32_t src_length;
+    if (!find(tag, type, src, src_length) || type != 'i' || src_length == 0) {
+        return false;
+    }
+    bool is_negative = src[0] == '-';
+    std::uint32_t begin = is_negative || src[0] == '+';
+    if (begin == src_length) {
+        return false;
+    }
+    // magnitude of INT64_MIN is one larger than INT64_MAX
+    std::uint64_t max_magnitude =
+        static_cast<std::uint64_t>(INT64_MAX) + is_negative;
+    std::uint64_t magnitude = 0;
+    for (std::uint32_t i = begin; i < src_length; ++i) {
+        std::uint32_t digit = src[i] - '0';
+        if (digit > 9 || magnitude > (max_magnitude - digit) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    value = is_negative && magnitude != 0 ?
+        -static_cast<std::int64_t>(magnitude - 1) - 1 :
+        static_cast<std::int64_t>(magnitude);
+    return true;
+}
+
+inline bool SamTags::find(const char* tag, double& value) const {
+    char type;
+    const char* src;
+    std::uint32_t src_length;
+    if (!find(tag, type, src, src_length) || type != 'f') {
+        return false;
+    }
+    // fields are not null terminated
+    char text[64];
+    src_length = std::min<std::uint32_t>(src_length, sizeof(text) - 1);
+    std::memcpy(text, src, src_length);
+    text[src_length] = 0;
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text;
+}
+
+inline SamCigar::SamCigar()
+        : operations_(), query_span_(0), target_span_(0), aligned_bases_(0),
+        matches_(0), mismatches_(0), insertions_(0), deletions_(0) {
+}
+
+// maps MIDNSHP=X to their BAM codes and everything else to 15
+inline const std::uint8_t* cigarTable() {
+    static const std::vector<std::uint8_t> table = [] () ->
+        std::vector<std::uint8_t> {
+
+        const char kOperations[] = "MIDNSHP=X";
+        std::vector<std::uint8_t> dst(256, 15);
+        for (std::uint8_t i = 0; i < 9; ++i) {
+            dst[static_cast<std::uint8_t>(kOperations[i])] = i;
+        }
+        return dst;
+    }();
+    return table.data();
+}
+
+inline bool SamCigar::reset(const char* src, std::uint32_t src_length) {
+    operations_.clear();
+    query_span_ = target_span_ = aligned_bases_ = matches_ = mismatches_ =
+        insertions_ = deletions_ = 0;
+
+    if (src_length == 1 && src[0] == '*') {
+        return true;
+    }
+
+    // bit i is set if operation i consumes query or target bases
+    const std::uint32_t kQueryMask = 0x193, kTargetMask = 0x18D;
+
+    auto table = cigarTable();
+    std::uint64_t length = 0;
+    std::uint32_t num_digits = 0;
+    for (std::uint32_t i = 0; i < src_length; ++i) {
+        std::uint32_t digit = src[i] - '0';
+        if (digit < 10) {
+            length = length * 10 + digit;
+            if (++num_digits > 9) {
+                return false;
+            }
+            continue;
+        }
+        std::uint32_t op = table[static_cast<std::uint8_t>(src[i])];
+        if (op > 8 || num_digits == 0 || length >= (1U << 28)) {
+            return false;
+        }
+        operations_.emplace_back(length << 4 | op);
+
+        std::uint32_t op_length = length;
+        query_span_ += op_length & -((kQueryMask >> op) & 1);
+        target_span_ += op_length & -((kTargetMask >> op) & 1);
+        switch (op) {
+            case 0: aligned_bases_ += op_length; break;
+            case 1: insertions_ += op_length; break;
+            case 2: deletions_ += op_length; break;
+            case 7: aligned_bases_ += op_length; matches_ += op_length; break;
+            case 8:
+                aligned_bases_ += op_length;
+                mismatches_ += op_length;
+                break;
+            default: break;
+        }
+
+        length = 0;
+        num_digits = 0;
+    }
+    return num_digits == 0 && !operations_.empty();
+}
+
+inline const std::uint32_t* SamCigar::data() const {
+    return operations_.data();
+}
+
+inline std::uint32_t SamCigar::size() const {
+    return operations_.size();
+}
+
+inline std::uint32_t SamCigar::query_span() const {
+    return query_span_;
+}
+
+inline std::uint32_t SamCigar::target_span() const {
+    return target_span_;
+}
+
+inline std::uint32_t SamCigar::aligned_bases() const {
+    return aligned_bases_;
+}
+
+inline std::uint32_t SamCigar::matches() const {
+    return matches_;
+}
+
+inline std::uint32_t SamCigar::mismatches() const {
+    return mismatches_;
+}
+
+inline std::uint32_t SamCigar::insertions() const {
+    return insertions_;
+}
+
+inline std::uint32_t SamCigar::deletions() const {
+    return deletions_;
+}
+
+// parses an unsigned decimal without the locale handling of atoi, returns
+// false and sets dst to 0 if src holds anything but digits or does not fit
+// into 32 bits
+inline bool parseUint32(const char* src, std::uint32_t src_length,
+    std::uint32_t& dst) {
+
+    dst = 0;
+    if (src_length == 0) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < src_length; ++i) {
+        std::uint32_t digit = src[i] - '0';
+        if (digit > 9 || dst > (static_cast<std::uint32_t>(-1) - digit) / 10) {
+            dst = 0;
+            return false;
+        }
+        dst = dst * 10 + digit;
+    }
+    return true;
+}
+
+inline SamHeader::SamHeader()
+        : names_(), lengths_(), ids_(), last_id_(-1) {
+}
+
+inline std::uint32_t SamHeader::size() const {
+    return names_.size();
+}
+
+inline const std::string& SamHeader::name(std::uint32_t id) const {
+    return names_[id];
+}
+
+inline std::uint32_t SamHeader::length(std::uint32_t id) const {
+    return lengths_[id];
+}
+
+inline std::uint32_t SamHeader::id(const char* name,
+    std::uint32_t name_length) const {
+
+    if (last_id_ < names_.size() && names_[last_id_].size() == name_length &&
+        std::memcmp(names_[last_id_].data(), name, name_length) == 0) {
+        return last_id_;
+    }
+    auto it = ids_.find(std::string(name, name_length));
+    if (it == ids_.end()) {
+        return -1;
+    }
+    return last_id_ = it->second;
+}
+
+inline std::uint32_t SamHeader::id(const std::string& name) const {
+    return id(name.data(), name.size());
+}
+
+inline void SamHeader::clear() {
+    names_.clear();
+    lengths_.clear();
+    ids_.clear();
+    last_id_ = -1;
+}
+
+inline bool SamHeader::add(const char* name, std::uint32_t name_length,
+    std::uint32_t length) {
+
+    auto it = ids_.emplace(std::string(name, name_length), names_.size());
+    if (!it.second) {
+        return false;
+    }
+    names_.emplace_back(it.first->first);
+    lengths_.emplace_back(length);
+    return true;
+}
+
+inline void SamHeader::parse(const char* line, std::uint32_t line_length) {
+
+    if (line_length < 4 || std::memcmp(line, "@SQ\t", 4) != 0) {
+        return;
+    }
+
+    const char* name = nullptr;
+    std::uint32_t name_length = 0, length = 0;
+    bool has_length = false;
+    for (std::uint32_t begin = 4; begin < line_length;) {
+        auto end = static_cast<const char*>(std::memchr(&line[begin], '\t',
+            line_length - begin));
+        std::uint32_t field_length = (end == nullptr ?
+            line_length : end - line) - begin;
+        if (field_length >= 3 && line[begin + 2] == ':') {
+            if (line[begin] == 'S' && line[begin + 1] == 'N') {
+                name = &line[begin + 3];
+                name_length = field_length - 3;
+            } else if (line[begin] == 'L' && line[begin + 1] == 'N') {
+                has_length = parseUint32(&line[begin + 3], field_length - 3,
+                    length);
+            }
+        }
+        begin += field_length + 1;
+    }
+
+    if (name_length == 0 || !has_length) {
+        throw std::invalid_argument("[bioparser::SamParser] error: "
+            "invalid @SQ header line!");
+    }
+    if (!add(name, name_length, length)) {
+        throw std::invalid_argument("[bioparser::SamParser] error: "
+            "duplicate reference " + std::string(name, name_length) +
+            " in the header!");
+    }
+}
+
+inline BatchLimits::BatchLimits()
+        : max_records(0), max_bases(0), max_memory(0) {
+}
+
+inline ReadFilter::ReadFilter()
+        : min_length(0), max_length(-1), min_mean_quality(0),
+        max_n_fraction(1) {
+}
+
+// true if filter rejects anything
+inline bool isActive(const ReadFilter& filter) {
+    return filter.min_length > 0 ||
+        filter.max_length != static_cast<std::uint32_t>(-1) ||
+        filter.min_mean_quality > 0 || filter.max_n_fraction < 1;
+}
+
+// quality is ignored if it is empty
+inline bool isAccepted(const ReadFilter& filter, const char* sequence,
+    std::uint32_t sequence_length, const char* quality,
+    std::uint32_t quality_length) {
+
+    if (sequence_length < filter.min_length ||
+        sequence_length > filter.max_length) {
+        return false;
+    }
+    // sequences of headers only parses are not available
+    if (filter.max_n_fraction < 1 && sequence != nullptr) {
+        std::uint64_t num_n = 0;
+        for (std::uint32_t i = 0; i < sequence_length; ++i) {
+            num_n += (sequence[i] | 0x20) == 'n';
+        }
+        if (num_n > filter.max_n_fraction * sequence_length) {
+            return false;
+        }
+    }
+    if (filter.min_mean_quality > 0 && quality_length > 0) {
+        std::uint64_t sum = 0;
+        for (std::uint32_t i = 0; i < quality_length; ++i) {
+            sum += static_cast<std::uint8_t>(quality[i]);
+        }
+        if (sum < (filter.min_mean_quality + 33) * quality_length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline OverlapFilter::OverlapFilter()
+        : min_length(0), min_identity(0), min_mapping_quality(0),
+        excluded_flags(0), remove_self_overlaps(false) {
+}
+
+// true if filter rejects anything
+inline bool isActive(const OverlapFilter& filter) {
+    return filter.min_length > 0 || filter.min_identity > 0 ||
+        filter.min_mapping_quality > 0 || filter.excluded_flags != 0 ||
+        filter.remove_self_overlaps;
+}
+
+// length of [begin, end), 0 if end precedes begin
+inline std::uint32_t span(std::uint32_t begin, std::uint32_t end) {
+    return end > begin ? end - begin : 0;
+}
+
+// bit mask of 0-based columns
+inline std::uint32_t columnMask(std::initializer_list<std::uint32_t> columns) {
+    std::uint32_t mask = 0;
+    for (const auto& it: columns) {
+        if (it < 32) {
+            mask |= 1U << it;
+        }
+    }
+    return mask;
+}
+
+inline NameTable::NameTable()
+        : names_(), slots_(1024, 0), mutex_() {
+}
+
+inline std::uint32_t NameTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+inline const std::string& NameTable::name(std::uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_[id];
+}
+
+inline std::uint64_t NameTable::slot(const char* name,
+    std::uint32_t name_length) const {
+
+    // FNV-1a
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (std::uint32_t i = 0; i < name_length; ++i) {
+        hash = (hash ^ static_cast<std::uint8_t>(name[i])) * 0x100000001B3ULL;
+    }
+
+    std::uint64_t mask = slots_.size() - 1;
+    for (std::uint64_t i = hash & mask; ; i = (i + 1) & mask) {
+        if (slots_[i] == 0) {
+            return i;
+        }
+        const auto& it = names_[slots_[i] - 1];
+        if (it.size() == name_length &&
+            std::memcmp(it.data(), name, name_length) == 0) {
+            return i;
+        }
+    }
+}
+
+inline void NameTable::grow() {
+    slots_.assign(slots_.size() * 2, 0);
+    for (std::uint32_t i = 0; i < names_.size(); ++i) {
+        slots_[slot(names_[i].data(), names_[i].size())] = i + 1;
+    }
+}
+
+inline std::uint32_t NameTable::id(const char* name,
+    std::uint32_t name_length) const {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_[slot(name, name_length)] - 1;
+}
+
+inline std::uint32_t NameTable::id(const std::string& name) const {
+    return id(name.data(), name.size());
+}
+
+inline std::uint32_t NameTable::insert(const char* name,
+    std::uint32_t name_length) {
+
+    auto i = slot(name, name_length);
+    if (slots_[i] != 0) {
+        return slots_[i] - 1;
+    }
+    names_.emplace_back(name, name_length);
+    slots_[i] = names_.size();
+    // load factor is kept at most 1/2
+    if (2 * names_.size() > slots_.size()) {
+        grow();
+    }
+    return names_.size() - 1;
+}
+
+inline std::uint32_t NameTable::intern(const char* name,
+    std::uint32_t name_length) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insert(name, name_length);
+}
+
+inline std::uint32_t NameTable::intern(const std::string& name) {
+    return intern(name.data(), name.size());
+}
+
+inline void NameTable::intern(const char* first, std::uint32_t first_length,
+    const char* second, std::uint32_t second_length,
+    std::uint32_t& first_id, std::uint32_t& second_id) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    first_id = insert(first, first_length);
+    second_id = insert(second, second_length);
+}
+
+inline BedIntervals::BedIntervals()
+        : names_(), ids_(), last_id_(-1), offsets_(1, 0), begins_(), ends_(),
+        max_ends_(), new_ids_(), new_begins_(), new_ends_() {
+}
+
+inline const std::vector<std::string>& BedIntervals::names() const {
+    return names_;
+}
+
+inline const std::vector<std::uint64_t>& BedIntervals::offsets() const {
+    return offsets_;
+}
+
+inline const std::vector<std::uint32_t>& BedIntervals::begins() const {
+    return begins_;
+}
+
+inline const std::vector<std::uint32_t>& BedIntervals::ends() const {
+    return ends_;
+}
+
+inline const std::vector<std::uint32_t>& BedIntervals::max_ends() const {
+    return max_ends_;
+}
+
+inline std::uint32_t BedIntervals::id(const std::string& name) const {
+    auto it = ids_.find(name);
+    return it == ids_.end() ? -1 : it->second;
+}
+
+inline bool BedIntervals::overlaps(std::uint32_t id, std::uint32_t begin,
+    std::uint32_t end) const {
+
+    if (id >= names_.size() || begin >= end) {
+        return false;
+    }
+    // the last interval starting before end is the only candidate as max_ends
+    // covers all intervals before it
+    auto first = begins_.begin() + offsets_[id];
+    auto it = std::lower_bound(first, begins_.begin() + offsets_[id + 1], end);
+    if (it == first) {
+        return false;
+    }
+    return max_ends_[it - begins_.begin() - 1] > begin;
+}
+
+inline bool BedIntervals::overlaps(const std::string& name,
+    std::uint32_t begin, std::uint32_t end) const {
+    return overlaps(id(name), begin, end);
+}
+
+inline std::uint32_t BedIntervals::intern(const char* name,
+    std::uint32_t name_length) {
+
+    // intervals are usually grouped by chromosome
+    if (last_id_ < names_.size() && names_[last_id_].size() == name_length &&
+        std::memcmp(names_[last_id_].data(), name, name_length) == 0) {
+        return last_id_;
+    }
+
+    auto it = ids_.emplace(std::string(name, name_length), names_.size());
+    if (it.second) {
+        names_.emplace_back(it.first->first);
+    }
+    return last_id_ = it.first->second;
+}
+
+inline void BedIntervals::sort() {
+
+    if (new_ids_.empty() && offsets_.size() == names_.size() + 1) {
+        return;
+    }
+
+    struct Interval {
+        std::uint32_t id;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    auto is_less = [] (const Interval& lhs, const Interval& rhs) -> bool {
+        return lhs.id < rhs.id ||
+            (lhs.id == rhs.id && (lhs.begin < rhs.begin ||
+            (lhs.begin == rhs.begin && lhs.end < rhs.end)));
+    };
+
+    // only new intervals are sorted, each chromosome then merges its sorted
+    // old and new intervals
+    std::vector<Interval> new_intervals(new_ids_.size());
+    for (std::uint64_t i = 0; i < new_ids_.size(); ++i) {
+        new_intervals[i] = {new_ids_[i], new_begins_[i], new_ends_[i]};
+    }
+    std::sort(new_intervals.begin(), new_intervals.end(), is_less);
+
+    std::vector<Interval> intervals;
+    intervals.reserve(begins_.size() + new_intervals.size());
+    std::vector<std::uint64_t> offsets(names_.size() + 1, 0);
+    auto it = new_intervals.begin();
+    for (std::uint32_t i = 0; i < names_.size(); ++i) {
+        if (i + 1 < offsets_.size()) {
+            for (auto j = offsets_[i]; j < offsets_[i + 1]; ++j) {
+                intervals.push_back({i, begins_[j], ends_[j]});
+            }
+        }
+        auto middle = intervals.size();
+        for (; it != new_intervals.end() && it->id == i; ++it) {
+            intervals.emplace_back(*it);
+        }
+        std::inplace_merge(intervals.begin() + offsets[i],
+            intervals.begin() + middle, intervals.end(), is_less);
+        offsets[i + 1] = intervals.size();
+    }
+    std::vector<Interval>().swap(new_intervals);
+
+    offsets_.swap(offsets);
+    begins_.resize(intervals.size());
+    ends_.resize(intervals.size());
+    max_ends_.resize(intervals.size());
+    for (std::uint64_t i = 0; i < intervals.size(); ++i) {
+        const auto& jt = intervals[i];
+        begins_[i] = jt.begin;
+        ends_[i] = jt.end;
+        max_ends_[i] = i > 0 && intervals[i - 1].id == jt.id ?
+            std::max(max_ends_[i - 1], jt.end) : jt.end;
+    }
+
+    new_ids_.clear();
+    new_begins_.clear();
+    new_ends_.clear();
+}
+
+inline OverlapStore::OverlapStore()
+        : data_(), offsets_(1, 0), size_(0), new_records_(), names_() {
+}
+
+inline std::uint64_t OverlapStore::size() const {
+    return size_;
+}
+
+inline std::uint32_t OverlapStore::num_queries() const {
+    return offsets_.size() - 1;
+}
+
+inline std::uint64_t OverlapStore::size_in_bytes() const {
+    return data_.size() + offsets_.size() * sizeof(std::uint64_t) +
+        new_records_.capacity() * sizeof(Record);
+}
+
+inline const std::shared_ptr<NameTable>& OverlapStore::names() const {
+    return names_;
+}
+
+inline OverlapStore::Iterator OverlapStore::begin() const {
+    return Iterator(this, 0, 0, data_.size());
+}
+
+inline OverlapStore::Iterator OverlapStore::end() const {
+    return Iterator(this, 0, data_.size(), data_.size());
+}
+
+inline OverlapStore::Iterator OverlapStore::begin(std::uint32_t q_id) const {
+    if (q_id >= num_queries()) {
+        return end();
+    }
+    return Iterator(this, q_id, offsets_[q_id], offsets_[q_id + 1]);
+}
+
+inline OverlapStore::Iterator OverlapStore::end(std::uint32_t q_id) const {
+    if (q_id >= num_queries()) {
+        return end();
+    }
+    return Iterator(this, q_id, offsets_[q_id + 1], offsets_[q_id + 1]);
+}
+
+inline void OverlapStore::add(const Record& record) {
+    new_records_.emplace_back(record);
+}
+
+inline void OverlapStore::encode(const Record& prev, const Record& record,
+    std::vector<std::uint8_t>& dst) {
+
+    auto put = [&] (std::uint64_t value) -> void {
+        while (value >= 0x80) {
+            dst.emplace_back(value | 0x80);
+            value >>= 7;
+        }
+        dst.emplace_back(value);
+    };
+    // zigzag encoding of signed differences
+    auto put_difference = [&] (std::uint32_t lhs, std::uint32_t rhs) -> void {
+        std::int64_t value = static_cast<std::int64_t>(lhs) - rhs;
+        put(value < 0 ? (static_cast<std::uint64_t>(-value) << 1) - 1 :
+            static_cast<std::uint64_t>(value) << 1);
+    };
+
+    // targets are sorted within a query, query begins within a target
+    bool is_same_target = record.t_id == prev.t_id;
+    std::uint32_t q_span = record.q_end - record.q_begin;
+    std::uint32_t t_span = record.t_end - record.t_begin;
+
+    put(static_cast<std::uint64_t>(record.t_id - prev.t_id) << 1 |
+        (record.orientation == '-'));
+    put(record.q_begin - (is_same_target ? prev.q_begin : 0));
+    put_difference(record.q_end, record.q_begin);
+    put_difference(record.q_length, prev.q_length);
+    put_difference(record.t_length, prev.t_length);
+    put(record.t_begin);
+    put_difference(t_span, q_span);
+    put_difference(record.block_length, std::max(q_span, t_span));
+    put_difference(record.block_length, record.matching_bases);
+    put(record.mapping_quality);
+}
+
+inline void OverlapStore::decode(const std::uint8_t*& src, Record& record) {
+
+    auto get = [&] () -> std::uint64_t {
+        std::uint64_t value = 0;
+        for (std::uint32_t shift = 0; ; shift += 7) {
+            std::uint8_t byte = *src++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+    };
+    auto get_difference = [&] (std::uint32_t rhs) -> std::uint32_t {
+        std::uint64_t value = get();
+        return value & 1 ? rhs - static_cast<std::uint32_t>((value + 1) >> 1) :
+            rhs + static_cast<std::uint32_t>(value >> 1);
+    };
+
+    std::uint64_t value = get();
+    std::uint32_t t_id = record.t_id + (value >> 1);
+    record.orientation = value & 1 ? '-' : '+';
+    record.q_begin = (t_id == record.t_id ? record.q_begin : 0) + get();
+    record.t_id = t_id;
+    record.q_end = get_difference(record.q_begin);
+    record.q_length = get_difference(record.q_length);
+    record.t_length = get_difference(record.t_length);
+    record.t_begin = get();
+
+    std::uint32_t q_span = record.q_end - record.q_begin;
+    std::uint32_t t_span = get_difference(q_span);
+    record.t_end = record.t_begin + t_span;
+    record.block_length = get_difference(std::max(q_span, t_span));
+    record.matching_bases = record.block_length - get_difference(0);
+    record.mapping_quality = get();
+}
+
+inline void OverlapStore::merge(bool is_last) {
+
+    if (new_records_.empty() || (!is_last &&
+        new_records_.size() * sizeof(Record) < data_.size())) {
+        return;
+    }
+
+    std::stable_sort(new_records_.begin(), new_records_.end(),
+        [] (const Record& lhs, const Record& rhs) -> bool {
+            return lhs.q_id < rhs.q_id ||
+                (lhs.q_id == rhs.q_id && (lhs.t_id < rhs.t_id ||
+                (lhs.t_id == rhs.t_id && lhs.q_begin < rhs.q_begin)));
+        });
+
+    std::uint32_t num_queries = std::max(this->num_queries(),
+        new_records_.back().q_id + 1);
+
+    std::vector<std::uint8_t> data;
+    data.reserve(data_.size() + new_records_.size() * 16);
+    std::vector<std::uint64_t> offsets(1, 0);
+    offsets.reserve(num_queries + 1);
+
+    // blocks without new overlaps are copied as they are
+    std::vector<Record> records;
+    auto it = new_records_.begin();
+    for (std::uint32_t i = 0; i < num_queries; ++i) {
+        auto jt = it;
+        while (jt != new_records_.end() && jt->q_id == i) {
+            ++jt;
+        }
+        if (it == jt) {
+            if (i < this->num_queries()) {
+                data.insert(data.end(), data_.begin() + offsets_[i],
+                    data_.begin() + offsets_[i + 1]);
+            }
+        } else {
+            records.assign(begin(i), end(i));
+            auto size = records.size();
+            records.insert(records.end(), it, jt);
+            std::inplace_merge(records.begin(), records.begin() + size,
+                records.end(), [] (const Record& lhs, const Record& rhs) {
+                    return lhs.t_id < rhs.t_id ||
+                        (lhs.t_id == rhs.t_id && lhs.q_begin < rhs.q_begin);
+                });
+
+            Record prev = Record();
+            for (const auto& kt: records) {
+                encode(prev, kt, data);
+                prev = kt;
+            }
+            it = jt;
+        }
+        offsets.emplace_back(data.size());
+    }
+
+    data.shrink_to_fit();
+    data_.swap(data);
+    offsets_.swap(offsets);
+    size_ += new_records_.size();
+    std::vector<Record>().swap(new_records_);
+}
+
+inline OverlapStore::Iterator::Iterator(const OverlapStore* store,
+    std::uint32_t q_id, std::uint64_t begin, std::uint64_t end)
+        : store_(store), begin_(begin), next_(begin), end_(end),
+        record_() {
+
+    record_.q_id = q_id;
+    if (begin_ != end_) {
+        decode();
+    }
+}
+
+inline const OverlapStore::Record& OverlapStore::Iterator::operator*()
+    const {
+    return record_;
+}
+
+inline const OverlapStore::Record* OverlapStore::Iterator::operator->()
+    const {
+    return &record_;
+}
+
+inline OverlapStore::Iterator& OverlapStore::Iterator::operator++() {
+    begin_ = next_;
+    if (begin_ != end_) {
+        decode();
+    }
+    return *this;
+}
+
+inline bool OverlapStore::Iterator::operator==(const Iterator& other) const {
+    return store_ == other.store_ && begin_ == other.begin_;
+}
+
+inline bool OverlapStore::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+inline void OverlapStore::Iterator::decode() {
+    // skips exhausted (and empty) blocks, deltas restart with each query
+    while (begin_ == store_->offsets_[record_.q_id + 1]) {
+        auto q_id = record_.q_id + 1;
+        record_ = Record();
+        record_.q_id = q_id;
+    }
+    const std::uint8_t* src = &(store_->data_[begin_]);
+    OverlapStore::decode(src, record_);
+    next_ = src - store_->data_.data();
+}
+
+inline bool isNumber(const char* src, std::uint32_t src_length) {
+    std::uint32_t i = src_length > 1 && src[0] == '-' ? 1 : 0;
+    if (i == src_length) {
+        return false;
+    }
+    for (; i < src_length; ++i) {
+        if (!isdigit(src[i]) && src[i] != '.') {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline Format detectFormat(const char* data, std::uint32_t data_length) {
+
+    if (data_length >= 4 && data[0] == 'B' && data[1] == 'A' &&
+        data[2] == 'M' && data[3] == 1) {
+        return Format::kBam;
+    }
+    if (data_length >= 4 && (readLittleEndian32(data) == 0x1A412743 ||
+        readLittleEndian32(data) == 0x4327411A)) {
+        return Format::kTwoBit;
+    }
+    if (data_length == 0) {
+        return Format::kUnknown;
+    }
+    if (data[0] == '>') {
+        return Format::kFasta;
+    }
+    if (data[0] == '@') {
+        // SAM header lines have a two letter record type
+        return data_length > 3 && isalpha(data[1]) && isalpha(data[2]) &&
+            data[3] == '\t' ? Format::kSam : Format::kFastq;
+    }
+
+    // comments and BED track lines
+    auto it = static_cast<const char*>(std::memchr(data, '\n', data_length));
+    while (it != nullptr && (data[0] == '#' ||
+        (data_length > 5 && std::strncmp(data, "track", 5) == 0) ||
+        (data_length > 7 && std::strncmp(data, "browser", 7) == 0))) {
+        data_length -= it - data + 1;
+        data = it + 1;
+        it = static_cast<const char*>(std::memchr(data, '\n', data_length));
+    }
+    std::uint32_t line_length = it == nullptr ? data_length : it - data;
+    rightStrip(data, line_length);
+
+    const std::uint32_t kMaxValues = 12;
+    const char* values[kMaxValues];
+    std::uint32_t lengths[kMaxValues];
+    std::uint32_t num_values = 0;
+
+    char delimiter = std::memchr(data, '\t', line_length) != nullptr ? '\t' : ' ';
+    for (std::uint32_t begin = 0; num_values < kMaxValues;) {
+        auto end = static_cast<const char*>(std::memchr(&data[begin],
+            delimiter, line_length - begin));
+        values[num_values] = &data[begin];
+        lengths[num_values] = (end == nullptr ? line_length : end - data) - begin;
+        ++num_values;
+        if (end == nullptr) {
+            break;
+        }
+        begin = end - data + 1;
+    }
+
+    auto are_numbers = [&] (std::initializer_list<std::uint32_t> ids) -> bool {
+        for (const auto& id: ids) {
+            if (id >= num_values || !isNumber(values[id], lengths[id])) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (delimiter == ' ') {
+        return num_values == 12 && are_numbers({0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+            10, 11}) ? Format::kMhap : Format::kUnknown;
+    }
+    if (num_values == 12 && lengths[4] == 1 &&
+        (values[4][0] == '+' || values[4][0] == '-') &&
+        are_numbers({1, 2, 3, 6, 7, 8, 9, 10, 11})) {
+        return Format::kPaf;
+    }
+    if (num_values >= 11 && are_numbers({1, 3, 4, 7, 8})) {
+        return Format::kSam;
+    }
+    if (lengths[0] == 1 && std::strchr("HSLPEFGOUWJC", values[0][0]) != nullptr) {
+        return Format::kGfa;
+    }
+    if (num_values >= 3 && are_numbers({1, 2})) {
+        return Format::kBed;
+    }
+    return Format::kUnknown;
+}
+
+// true if sequences (and qualities) of records in the first block of a FASTA
+// or FASTQ file are not wrapped into multiple lines
+inline bool isSingleLine(const char* data, std::uint32_t data_length) {
+
+    bool is_fastq = data_length > 0 && data[0] == '@';
+    std::uint32_t line_id = 0;
+    std::uint32_t sequence_length = 0;
+
+    for (std::uint32_t begin = 0; begin < data_length; ++line_id) {
+        auto end = static_cast<const char*>(std::memchr(&data[begin], '\n',
+            data_length - begin));
+        if (end == nullptr) {
+            break;
+        }
+        std::uint32_t length = end - data - begin;
+
+        if (is_fastq) {
+            switch (line_id % 4) {
+                case 0: if (data[begin] != '@') return false; break;
+                case 1: sequence_length = length; break;
+                case 2: if (data[begin] != '+') return false; break;
+                default: if (length != sequence_length) return false; break;
+            }
+        } else if (data[begin] == '>') {
+            line_id = 0;
+        } else if (line_id > 1) {
+            return false;
+        }
+        begin += length + 1;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Text parsers read through zlib, binary ones read raw bytes
+ */
+template<template<class> class P>
+struct ParserInput {
+    using type = gzFile;
+};
+
+template<>
+struct ParserInput<BamParser> {
+    using type = std::FILE*;
+};
+
+template<>
+struct ParserInput<TwoBitParser> {
+    using type = std::FILE*;
+};
+
+inline gzFile openInput(const std::string& path, gzFile) {
+    return gzopen(path.c_str(), "r");
+}
+
+inline std::FILE* openInput(const std::string& path, std::FILE*) {
+    return std::fopen(path.c_str(), "rb");
+}
+
+template<template<class> class P, class T>
+inline std::unique_ptr<P<T>> createParser(const std::string& path) {
+
+    auto input_file = openInput(path, typename ParserInput<P>::type());
+    if (input_file == nullptr) {
+        throw std::invalid_argument("[bioparser::createParser] error: "
+            "unable to open file " + path + "!");
+    }
+
+    auto parser = std::unique_ptr<P<T>>(new P<T>(input_file));
+    parser->path_ = path;
+    return parser;
+}
+
+template<template<class> class P, class T>
+inline std::unique_ptr<Parser<T>> createSupportedParser(const std::string& path,
+    std::true_type) {
+
+    return createParser<P, T>(path);
+}
+
+template<template<class> class P, class T>
+inline std::unique_ptr<Parser<T>> createSupportedParser(const std::string& path,
+    std::false_type) {
+
+    throw std::invalid_argument("[bioparser::createParser] error: "
+        "missing constructor for the format of file " + path + "!");
+}
+
+template<class T>
+inline std::unique_ptr<Parser<T>> createParser(const std::string& path) {
+
+    auto input_file = gzopen(path.c_str(), "r");
+    if (input_file == nullptr) {
+        throw std::invalid_argument("[bioparser::createParser] error: "
+            "unable to open file " + path + "!");
+    }
+    std::vector<char> data(kBufferSize, 0);
+    auto data_length = gzread(input_file, data.data(), data.size());
+    gzclose(input_file);
+
+    switch (detectFormat(data.data(), std::max(data_length, 0))) {
+        case Format::kFasta:
+            return createSupportedParser<FastaParser, T>(path,
+                std::integral_constant<bool, FastaParser<T>::is_supported()>());
+        case Format::kFastq:
+            return createSupportedParser<FastqParser, T>(path,
+                std::integral_constant<bool, FastqParser<T>::is_supported()>());
+        case Format::kMhap:
+            return createSupportedParser<MhapParser, T>(path,
+                std::integral_constant<bool, MhapParser<T>::is_supported()>());
+        case Format::kPaf:
+            return createSupportedParser<PafParser, T>(path,
+                std::integral_constant<bool, PafParser<T>::is_supported()>());
+        case Format::kSam:
+            return createSupportedParser<SamParser, T>(path,
+                std::integral_constant<bool, SamParser<T>::is_supported()>());
+        case Format::kBam:
+            return createSupportedParser<BamParser, T>(path,
+                std::integral_constant<bool, BamParser<T>::is_supported()>());
+        case Format::kGfa:
+            return createSupportedParser<GfaParser, T>(path,
+                std::integral_constant<bool, GfaParser<T>::is_supported()>());
+        case Format::kTwoBit:
+            return createSupportedParser<TwoBitParser, T>(path,
+                std::integral_constant<bool,
+                    TwoBitParser<T>::is_supported()>());
+        case Format::kBed:
+            return createSupportedParser<BedParser, T>(path,
+                std::integral_constant<bool, BedParser<T>::is_supported()>());
+        default:
+            throw std::invalid_argument("[bioparser::createParser] error: "
+                "unknown format of file " + path + "!");
+    }
+}
+
+template<class T>
+inline Parser<T>::Parser(gzFile input_file, std::uint32_t storage_size)
+        : input_file_(input_file, gzclose), buffer_(kBufferSize, 0),
+        storage_(storage_size, 0), path_(), is_cache_enabled_(false),
+        cache_(), limits_(), num_records_(0), num_bases_(0), memory_size_(0),
+        block_begin_(0), block_end_(0) {
+}
+
+template<class T>
+inline Parser<T>::~Parser() {
+}
+
+template<class T>
+inline void Parser<T>::reset() {
+    gzseek(this->input_file_.get(), 0, SEEK_SET);
+    // reopened by the next parse, which may use another trim mode
+    this->cache_.reset();
+    block_begin_ = block_end_ = 0;
+}
+
+template<class T>
+inline void Parser<T>::enable_cache() {
+    is_cache_enabled_ = true;
+}
+
+template<class T>
+inline void Parser<T>::set_limits(const BatchLimits& limits) {
+    limits_ = limits;
+}
+
+template<class T>
+inline std::uint64_t Parser<T>::read_block() {
+    if (block_begin_ == block_end_) {
+        return gzfread(buffer_.data(), sizeof(char), buffer_.size(),
+            input_file_.get());
+    }
+    auto length = block_end_ - block_begin_;
+    std::memmove(buffer_.data(), &buffer_[block_begin_], length);
+    block_begin_ = block_end_ = 0;
+    return length;
+}
+
+template<class T>
+inline bool Parser<T>::keep_block(std::uint64_t begin, std::uint64_t end) {
+    block_begin_ = begin;
+    block_end_ = end;
+    return !is_eof();
+}
+
+template<class T>
+inline bool Parser<T>::is_eof() const {
+    return block_begin_ == block_end_ && gzeof(input_file_.get());
+}
+
+template<class T>
+inline std::uint64_t Parser<T>::tell() const {
+    return gztell(input_file_.get()) - (block_end_ - block_begin_);
+}
+
+template<class T>
+inline void Parser<T>::open_batch() {
+    num_records_ = 0;
+    num_bases_ = 0;
+    memory_size_ = 0;
+}
+
+template<class T>
+inline void Parser<T>::count(std::uint64_t num_bases) {
+    ++num_records_;
+    num_bases_ += num_bases;
+}
+
+template<class T>
+inline void Parser<T>::count(std::uint64_t num_bases, const T& object,
+    std::uint64_t num_bytes) {
+    count(num_bases);
+    if (limits_.max_memory != 0) {
+        memory_size_ += sizeof(std::unique_ptr<T>) + objectSize(
+            decltype(hasSizeInBytes<T>(0))(), object, num_bytes);
+    }
+}
+
+template<class T>
+inline std::uint64_t Parser<T>::objectSize(std::true_type, const T& object,
+    std::uint64_t) {
+    return object.size_in_bytes();
+}
+
+template<class T>
+inline std::uint64_t Parser<T>::objectSize(std::false_type, const T&,
+    std::uint64_t num_bytes) {
+    return sizeof(T) + num_bytes;
+}
+
+template<class T>
+inline bool Parser<T>::is_batch_full() const {
+    return (limits_.max_records != 0 && num_records_ >= limits_.max_records) ||
+        (limits_.max_bases != 0 && num_bases_ >= limits_.max_bases) ||
+        (limits_.max_memory != 0 && memory_size_ >= limits_.max_memory);
+}
+
+template<class T>
+inline bool Parser<T>::open_cache(const std::string& format) {
+    if (cache_ != nullptr && cache_->format() != format) {
+        throw std::invalid_argument("[bioparser::Parser] error: "
+            "trim changed while the cache is open!");
+    }
+    if (is_cache_enabled_ && cache_ == nullptr &&
+        this->tell() == 0) {
+        cache_.reset(new ParserCache(path_, format));
+    }
+    return cache_ != nullptr && cache_->is_mapped();
+}
+
+template<class T>
+inline bool Parser<T>::parse(std::vector<std::shared_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    std::vector<std::unique_ptr<T>> tmp;
+    auto ret = this->parse_objects(tmp, max_bytes, trim);
+
+    dst.reserve(dst.size() + tmp.size());
+    for (auto& it: tmp) {
+        dst.emplace_back(std::move(it));
+    }
+    return ret;
+}
+
+template<class T>
+inline FastaParser<T>::FastaParser(gzFile input_file)
+        : Parser<T>(input_file, kSSS + kMSS), is_single_line_(false),
+        filter_(), is_filtered_(false) {
+}
+
+template<class T>
+inline void FastaParser<T>::set_filter(const ReadFilter& filter) {
+    filter_ = filter;
+    is_filtered_ = isActive(filter);
+}
+
+template<class T>
+inline T* FastaParser<T>::createT(std::false_type, const char* name,
+    std::uint32_t name_length, const char* sequence,
+    std::uint32_t sequence_length) {
+    return new T(name, name_length, sequence, sequence_length);
+}
+
+template<class T>
+inline T* FastaParser<T>::createT(std::true_type, const char* name,
+    std::uint32_t name_length, const char*, std::uint32_t sequence_length) {
+    return new T(name, name_length, sequence_length);
+}
+
+template<class T>
+inline FastaParser<T>::~FastaParser() {
+}
+
+template<class T>
+inline bool FastaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    return trim ?
+        parse<ParseOptions<Trim::kHard>>(dst, max_bytes) :
+        parse<ParseOptions<Trim::kSoft>>(dst, max_bytes);
+}
+
+template<class T>
+template<class O>
+inline bool FastaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes) {
+
+    // both are known at compile time, so are the branches on them
+    const bool trim = O::kTrim == Trim::kHard;
+    const bool kFullValidation = O::kValidation == Validation::kFull;
+
+    this->open_batch();
+    if (!is_filtered_ && !isHeaderOnly() &&
+        this->open_cache(trim ? "FastaParser" : "FastaParser,untrimmed")) {
+        return this->cache_->load(max_bytes,
+            [&] (const ParserCache::Record& record) -> bool {
+                dst.emplace_back(std::unique_ptr<T>(createT(
+                    std::integral_constant<bool, isHeaderOnly()>(),
+                    record.string(0), record.length(0),
+                    record.string(1), record.length(1))));
+                this->count(record.length(1), *dst.back(),
+                    record.length(0) + record.length(1));
+                return this->is_batch_full();
+            });
+    }
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    bool is_valid = false;
+    bool status = false;
+    std::uint64_t current_bytes = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    std::uint64_t last_object_id = num_objects;
+    std::uint32_t line_number = 0;
+
+    char* name = &(this->storage_[0]);
+    std::uint32_t name_length = 0;
+
+    char* sequence = &(this->storage_[kSSS]);
+    std::uint32_t sequence_length = 0;
+
+    // sequences are not copied beyond this length (one more than the
+    // filter's maximum to allow for a trailing whitespace)
+    std::uint64_t max_sequence_length = is_filtered_ ?
+        filter_.max_length + 1ULL : -1;
+    bool is_skipped = false;
+
+    // sequences of headers only parses are counted and never copied, their
+    // last byte is kept to strip a trailing carriage return
+    const bool kHeaderOnly = isHeaderOnly();
+    char sequence_end = 0;
+
+    auto reserve = [&] (std::uint64_t length) -> void {
+        if (kSSS + length >= this->storage_.size()) {
+            this->storage_.resize(kSSS + std::max<std::uint64_t>(kLSS,
+                2 * length), 0);
+            name = &(this->storage_[0]);
+            sequence = &(this->storage_[kSSS]);
+        }
+    };
+
+    auto create_T = [&] () -> void {
+        if (trim) {
+            rightStripHard(name, name_length);
+        } else {
+            rightStrip(name, name_length);
+        }
+        if (kHeaderOnly) {
+            if (sequence_length != 0 && isspace(sequence_end)) {
+                --sequence_length;
+            }
+        } else {
+            rightStrip(sequence, sequence_length);
+        }
+
+        if (name_length == 0 || (kFullValidation && (name[0] != '>' ||
+            (sequence_length == 0 && !is_skipped)))) {
+            throw std::invalid_argument("[bioparser::FastaParser] error: "
+                "invalid file format!");
+        }
+
+        if (!is_skipped && (!is_filtered_ || isAccepted(filter_,
+            kHeaderOnly ? nullptr : sequence, sequence_length, nullptr, 0))) {
+
+            dst.emplace_back(std::unique_ptr<T>(createT(
+                std::integral_constant<bool, isHeaderOnly()>(),
+                (const char*) &(name[1]), name_length - 1,
+                (const char*) sequence, sequence_length)));
+            this->count(sequence_length, *dst.back(), name_length - 1 +
+                (kHeaderOnly ? 0 : sequence_length));
+
+            if (this->cache_ != nullptr) {
+                this->cache_->store((const char*) &(name[1]), name_length - 1,
+                    (const char*) sequence, sequence_length);
+            }
+        }
+
+        // rejected records count as parsed for chunking
+        ++num_objects;
+        current_bytes = 1;
+        name_length = 1;
+        sequence_length = 0;
+        is_valid = false;
+        is_skipped = false;
+    };
+
+    while (!is_end) {
+
+        bool is_first_block = this->tell() == 0;
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+
+        if (is_first_block) {
+            is_single_line_ = isSingleLine(this->buffer_.data(), read_bytes);
+        }
+
+        total_bytes += read_bytes;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (last_object_id == num_objects) {
+                throw ChunkSizeError("[bioparser::FastaParser] error: "
+                    "too small chunk size!");
+            }
+            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
+            status = true;
+            break;
+        }
+
+        const char* buffer = this->buffer_.data();
+        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+
+            if (((is_single_line_ && line_number == 1) ||
+                (kHeaderOnly && line_number != 0)) && buffer[i] != '>') {
+                auto it = static_cast<const char*>(std::memchr(&buffer[i],
+                    '\n', read_bytes - i));
+                std::uint32_t j = it == nullptr ? read_bytes : it - buffer;
+
+                if (sequence_length + (j - i) > max_sequence_length) {
+                    is_skipped = true;
+                }
+                if (kHeaderOnly) {
+                    if (j != i) {
+                        sequence_end = buffer[j - 1];
+                    }
+                    sequence_length += j - i;
+                } else if (!is_skipped) {
+                    reserve(sequence_length + (j - i));
+                    std::memcpy(&sequence[sequence_length], &buffer[i], j - i);
+                    sequence_length += j - i;
+                }
+                current_bytes += j - i;
+                i = j;
+                if (i == read_bytes) {
+                    break;
+                }
+            }
+
+            auto c = buffer[i];
+
+            if (c == '\n') {
+                ++line_number;
+            } else if (c == '>' && line_number != 0) {
+                is_valid = true;
+                line_number = 0;
+            } else {
+                switch (line_number) {
+                    case 0:
+                        if (name_length < kSSS) {
+                            if (!(name_length == 0 && isspace(c))) {
+                                name[name_length++] = c;
+                            }
+                        }
+                        break;
+                    default:
+                        if (sequence_length == max_sequence_length) {
+                            is_skipped = true;
+                        }
+                        if (is_skipped) {
+                            break;
+                        }
+                        sequence[sequence_length++] = c;
+                        if (sequence_length == kMSS) {
+                            reserve(kMSS + 1);
+                        }
+                        break;
+                }
+            }
+
+            ++current_bytes;
+
+            if (is_valid) {
+                create_T();
+                // the next record starts with buffer[i]
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i, read_bytes);
+                    break;
+                }
+            }
+        }
+
+        if (this->is_batch_full()) {
+            break;
+        }
+        if (is_end && current_bytes != 0) {
+            create_T();
+        }
+    }
+
+    if (this->cache_ != nullptr) {
+        this->cache_->flush(!status);
+    }
+
+    return status;
+}
+
+template<class T>
+template<class H, class C>
+inline bool FastaParser<T>::stream(std::uint64_t max_bytes, H header, C chunk,
+    bool trim) {
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    std::uint64_t total_bytes = 0;
+    this->open_batch();
+
+    char* name = &(this->storage_[0]);
+    std::uint32_t name_length = 0;
+
+    // pieces of the current sequence are collected here up to kMSS bytes
+    char* sequence = &(this->storage_[kSSS]);
+    std::uint32_t sequence_length = 0;
+    std::uint64_t record_length = 0;
+
+    bool has_record = false;
+    bool is_name = false;
+    bool is_line_begin = true;
+
+    auto end_header = [&] () -> void {
+        if (trim) {
+            rightStripHard(name, name_length);
+        } else {
+            rightStrip(name, name_length);
+        }
+        if (name_length == 0) {
+            throw std::invalid_argument("[bioparser::FastaParser] error: "
+                "invalid file format!");
+        }
+        header((const char*) name, name_length);
+        is_name = false;
+    };
+
+    auto end_record = [&] () -> void {
+        if (is_name) {
+            end_header();
+        }
+        rightStrip(sequence, sequence_length);
+        if (record_length + sequence_length == 0) {
+            throw std::invalid_argument("[bioparser::FastaParser] error: "
+                "invalid file format!");
+        }
+        chunk((const char*) sequence, sequence_length, true);
+        this->count(record_length + sequence_length);
+        sequence_length = 0;
+        record_length = 0;
+    };
+
+    while (!is_end) {
+
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+        total_bytes += read_bytes;
+
+        const char* buffer = this->buffer_.data();
+        for (std::uint32_t i = 0; i < read_bytes;) {
+
+            if (is_line_begin && buffer[i] == '>') {
+                if (has_record) {
+                    end_record();
+                    if (max_bytes != 0 && total_bytes > max_bytes) {
+                        gzseek(input_file, -(read_bytes - i), SEEK_CUR);
+                        return true;
+                    }
+                    if (this->is_batch_full()) {
+                        return this->keep_block(i, read_bytes);
+                    }
+                }
+                has_record = true;
+                is_name = true;
+                name_length = 0;
+                ++i;
+                continue;
+            }
+            if (!has_record) {
+                throw std::invalid_argument("[bioparser::FastaParser] error: "
+                    "invalid file format!");
+            }
+
+            auto it = static_cast<const char*>(std::memchr(&buffer[i], '\n',
+                read_bytes - i));
+            std::uint32_t j = it == nullptr ? read_bytes : it - buffer;
+
+            if (is_name) {
+                // leading whitespace is skipped as in parse()
+                while (name_length == 0 && i < j && isspace(buffer[i])) {
+                    ++i;
+                }
+                std::uint32_t length = std::min(j - i, kSSS - name_length);
+                std::memcpy(&name[name_length], &buffer[i], length);
+                name_length += length;
+                if (j < read_bytes) {
+                    end_header();
+                }
+            } else {
+                for (std::uint32_t k = i; k < j;) {
+                    std::uint32_t length = std::min(j - k,
+                        kMSS - sequence_length);
+                    std::memcpy(&sequence[sequence_length], &buffer[k], length);
+                    sequence_length += length;
+                    k += length;
+                    if (sequence_length == kMSS) {
+                        // a carriage return is held back until the end of
+                        // its line is known
+                        bool is_pending = sequence[kMSS - 1] == '\r';
+                        sequence_length -= is_pending;
+                        chunk((const char*) sequence, sequence_length, false);
+                        record_length += sequence_length;
+                        sequence_length = 0;
+                        if (is_pending) {
+                            sequence[sequence_length++] = '\r';
+                        }
+                    }
+                }
+                if (j < read_bytes) {
+                    // drops carriage returns
+                    rightStrip(sequence, sequence_length);
+                }
+            }
+
+            is_line_begin = j < read_bytes;
+            i = j + 1;
+        }
+    }
+
+    if (has_record) {
+        end_record();
+    }
+
+    return false;
+}
+
+template<class T>
+inline FastqParser<T>::FastqParser(gzFile input_file)
+        : Parser<T>(input_file, kSSS + 2 * kMSS), filter_(),
+        is_filtered_(false) {
+}
+
+template<class T>
+inline void FastqParser<T>::set_filter(const ReadFilter& filter) {
+    filter_ = filter;
+    is_filtered_ = isActive(filter);
+}
+
+template<class T>
+inline T* FastqParser<T>::createT(std::integral_constant<int, 0>,
+    const char* name, std::uint32_t name_length, const char* sequence,
+    std::uint32_t sequence_length, const char* quality,
+    std::uint32_t quality_length) {
+    return new T(name, name_length, sequence, sequence_length, quality,
+        quality_length);
+}
+
+template<class T>
+inline T* FastqParser<T>::createT(std::integral_constant<int, 1>,
+    const char* name, std::uint32_t name_length, const char* sequence,
+    std::uint32_t sequence_length, const char*, std::uint32_t) {
+    return new T(name, name_length, sequence, sequence_length);
+}
+
+template<class T>
+inline T* FastqParser<T>::createT(std::integral_constant<int, 2>,
+    const char* name, std::uint32_t name_length, const char*,
+    std::uint32_t sequence_length, const char*, std::uint32_t) {
+    return new T(name, name_length, sequence_length);
+}
+
+template<class T>
+inline FastqParser<T>::~FastqParser() {
+}
+
+template<class T>
+inline bool FastqParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    return trim ?
+        parse<ParseOptions<Trim::kHard>>(dst, max_bytes) :
+        parse<ParseOptions<Trim::kSoft>>(dst, max_bytes);
+}
+
+template<class T>
+template<class O>
+inline bool FastqParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes) {
+
+    // both are known at compile time, so are the branches on them
+    const bool trim = O::kTrim == Trim::kHard;
+    const bool kFullValidation = O::kValidation == Validation::kFull;
+
+    this->open_batch();
+    if (!is_filtered_ && signature() == 0 &&
+        this->open_cache(trim ? "FastqParser" : "FastqParser,untrimmed")) {
+        return this->cache_->load(max_bytes,
+            [&] (const ParserCache::Record& record) -> bool {
+                dst.emplace_back(std::unique_ptr<T>(createT(
+                    std::integral_constant<int, signature()>(),
+                    record.string(0), record.length(0),
+                    record.string(1), record.length(1),
+                    record.string(2), record.length(2))));
+                this->count(record.length(1), *dst.back(),
+                    record.length(0) + record.length(1) + record.length(2));
+                return this->is_batch_full();
+            });
+    }
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    bool is_valid = false;
+    bool status = false;
+    std::uint64_t current_bytes = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    std::uint64_t last_object_id = num_objects;
+    std::uint32_t line_number = 0;
+
+    char* name = &(this->storage_[0]);
+    std::uint32_t name_length = 0;
+
+    char* sequence = &(this->storage_[kSSS]);
+    std::uint32_t sequence_length = 0;
+
+    char* quality = &(this->storage_[kSSS + kMSS]);
+    std::uint32_t quality_length = 0;
+
+    // sequences and qualities are not copied beyond this length (one more
+    // than the filter's maximum to allow for a trailing whitespace), their
+    // lengths are still counted to find the end of the record
+    std::uint64_t max_sequence_length = is_filtered_ ?
+        filter_.max_length + 1ULL : -1;
+    bool is_skipped = false;
+
+    // sequences and qualities of headers only parses are counted and never
+    // copied, the last sequence byte is kept to strip a trailing carriage
+    // return from both; qualities are neither copied if T does not take them
+    const bool kHeaderOnly = isHeaderOnly();
+    const bool kSkipsQuality = signature() != 0;
+    char sequence_end = 0;
+
+    auto reserve = [&] (std::uint64_t length) -> void {
+        if (kSSS + 2 * length >= this->storage_.size()) {
+            std::uint64_t capacity = std::max<std::uint64_t>(kLSS, 2 * length);
+            this->storage_.resize(kSSS + 2 * capacity, 0);
+            name = &(this->storage_[0]);
+            sequence = &(this->storage_[kSSS]);
+            quality = &(this->storage_[kSSS + capacity]);
+        }
+    };
+
+    auto create_T = [&] () -> void {
+        if (trim) {
+            rightStripHard(name, name_length);
+        } else {
+            rightStrip(name, name_length);
+        }
+        if (kHeaderOnly) {
+            if (sequence_length != 0 && isspace(sequence_end)) {
+                --sequence_length;
+                --quality_length;
+            }
+        } else if (!is_skipped) {
+            auto stripped_length = sequence_length;
+            rightStrip(sequence, sequence_length);
+            if (kSkipsQuality) {
+                stripped_length -= sequence_length;
+                quality_length -= std::min(quality_length, stripped_length);
+            } else {
+                rightStrip(quality, quality_length);
+            }
+        }
+
+        if (name_length == 0 || (kFullValidation && (name[0] != '@' ||
+            sequence_length == 0 || quality_length == 0 ||
+            sequence_length != quality_length))) {
+            throw std::invalid_argument("[bioparser::FastqParser] error: "
+                "invalid file format!");
+        }
+
+        if (!is_skipped && (!is_filtered_ || (kSkipsQuality ?
+            isAccepted(filter_, kHeaderOnly ? nullptr : sequence,
+                sequence_length, nullptr, 0) :
+            isAccepted(filter_, sequence, sequence_length, quality,
+                quality_length)))) {
+
+            dst.emplace_back(std::unique_ptr<T>(createT(
+                std::integral_constant<int, signature()>(),
+                (const char*) &(name[1]), name_length - 1,
+                (const char*) sequence, sequence_length,
+                (const char*) quality, quality_length)));
+            this->count(sequence_length, *dst.back(), name_length - 1 +
+                (kHeaderOnly ? 0 : sequence_length) +
+                (kSkipsQuality ? 0 : quality_length));
+
+            if (this->cache_ != nullptr) {
+                this->cache_->store((const char*) &(name[1]), name_length - 1,
+                    (const char*) sequence, sequence_length,
+                    (const char*) quality, quality_length);
+            }
+        }
+
+        // rejected records count as parsed for chunking
+        ++num_objects;
+        current_bytes = 0;
+        name_length = 0;
+        sequence_length = 0;
+        quality_length = 0;
+        is_valid = false;
+        is_skipped = false;
+    };
+
+    while (!is_end) {
+
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+
+        total_bytes += read_bytes;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (last_object_id == num_objects) {
+                throw ChunkSizeError("[bioparser::FastqParser] error: "
+                    "too small chunk size!");
+            }
+            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
+            status = true;
+            break;
+        }
+
+        const char* buffer = this->buffer_.data();
+        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+
+            // sequence and quality lines are copied at once, the state
+            // machine below only handles line breaks and the '+' separator;
+            // on line 3 every byte belongs to the quality, even '@' and '+'
+            if ((line_number == 1 && buffer[i] != '+') || line_number == 3) {
+
+                auto it = static_cast<const char*>(std::memchr(&buffer[i],
+                    '\n', read_bytes - i));
+                std::uint32_t j = it == nullptr ? read_bytes : it - buffer;
+
+                if (line_number == 1) {
+                    if (sequence_length + (j - i) > max_sequence_length) {
+                        is_skipped = true;
+                    }
+                    if (kHeaderOnly) {
+                        if (j != i) {
+                            sequence_end = buffer[j - 1];
+                        }
+                    } else if (!is_skipped) {
+                        reserve(sequence_length + (j - i));
+                        std::memcpy(&sequence[sequence_length], &buffer[i],
+                            j - i);
+                    }
+                    sequence_length += j - i;
+                } else {
+                    if (quality_length + (j - i) > sequence_length) {
+                        throw std::invalid_argument("[bioparser::FastqParser] "
+                            "error: invalid file format!");
+                    }
+                    if (!is_skipped && !kSkipsQuality) {
+                        std::memcpy(&quality[quality_length], &buffer[i],
+                            j - i);
+                    }
+                    quality_length += j - i;
+                }
+                current_bytes += j - i;
+                i = j;
+                if (i == read_bytes) {
+                    break;
+                }
+            }
+
+            auto c = buffer[i];
+
+            if (c == '\n') {
+                if (!(line_number == 1 || (line_number == 3 && quality_length < sequence_length))) {
+                    line_number = (line_number + 1) % 4;
+                    if (line_number == 0) {
+                        is_valid = true;
+                    }
+                }
+            } else if (line_number == 1 && c == '+') {
+                line_number = 2;
+            } else {
+                switch (line_number) {
+                    case 0:
+                        if (name_length < kSSS) {
+                            if (!(name_length == 0 && isspace(c))) {
+                                name[name_length++] = c;
+                            }
+                        }
+                        break;
+                    case 1:
+                        sequence[sequence_length++] = c;
+                        if (sequence_length == kMSS) {
+                            reserve(kMSS + 1);
+                        }
+                        break;
+                    case 2:
+                        // comment line starting with '+'
+                        // do nothing
+                        break;
+                    case 3:
+                        quality[quality_length++] = c;
+                        break;
+                    default:
+                        // never reaches this case
+                        break;
+                }
+            }
+
+            ++current_bytes;
+
+            if (is_valid) {
+                create_T();
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i + 1, read_bytes);
+                    break;
+                }
+            }
+        }
+
+        if (this->is_batch_full()) {
+            break;
+        }
+        if (is_end && current_bytes != 0) {
+            create_T();
+        }
+    }
+
+    if (this->cache_ != nullptr) {
+        this->cache_->flush(!status);
+    }
+
+    return status;
+}
+
+template<class T>
+inline MhapParser<T>::MhapParser(gzFile input_file)
+        : Parser<T>(input_file, kSSS), filter_(), is_filtered_(false),
+        projection_(-1) {
+}
+
+template<class T>
+inline void MhapParser<T>::set_filter(const OverlapFilter& filter) {
+    filter_ = filter;
+    is_filtered_ = isActive(filter);
+}
+
+template<class T>
+inline void MhapParser<T>::set_projection(
+    std::initializer_list<std::uint32_t> columns) {
+    projection_ = columnMask(columns);
+}
+
+template<class T>
+inline MhapParser<T>::~MhapParser() {
+}
+
+template<class T>
+inline bool MhapParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool) {
+
+    this->open_batch();
+    if (!is_filtered_ && projection_ == static_cast<std::uint32_t>(-1) &&
+        this->open_cache("MhapParser")) {
+        return this->cache_->load(max_bytes,
+            [&] (const ParserCache::Record& record) -> bool {
+                auto u32 = [&] (std::uint32_t column) -> std::uint32_t {
+                    return record.value<std::uint32_t>(column);
+                };
+                dst.emplace_back(std::unique_ptr<T>(new T(
+                    record.value<std::uint64_t>(0),
+                    record.value<std::uint64_t>(1),
+                    record.value<double>(2), u32(3),
+                    u32(4), u32(5), u32(6), u32(7),
+                    u32(8), u32(9), u32(10), u32(11))));
+                this->count(span(u32(5), u32(6)), *dst.back(), 0);
+                return this->is_batch_full();
+            });
+    }
+
+    std::uint32_t columns = projection_ |
+        (is_filtered_ ? columnMask({0, 1, 2, 5, 6, 9, 10}) : 0) |
+        (this->limits_.max_bases != 0 ? columnMask({5, 6}) : 0);
+
+    auto status = parse_lines(max_bytes, columns, [&] (std::uint64_t a_id,
+        std::uint64_t b_id, double error, std::uint32_t minmers,
+        std::uint32_t a_rc, std::uint32_t a_begin, std::uint32_t a_end,
+        std::uint32_t a_length, std::uint32_t b_rc, std::uint32_t b_begin,
+        std::uint32_t b_end, std::uint32_t b_length) -> void {
+
+        dst.emplace_back(std::unique_ptr<T>(new T(a_id, b_id, error,
+            minmers, a_rc, a_begin, a_end, a_length, b_rc, b_begin,
+            b_end, b_length)));
+        this->count(span(a_begin, a_end), *dst.back(), 0);
+
+        if (this->cache_ != nullptr) {
+            this->cache_->store(a_id, b_id, error, minmers, a_rc, a_begin,
+                a_end, a_length, b_rc, b_begin, b_end, b_length);
+        }
+    });
+
+    if (this->cache_ != nullptr) {
+        this->cache_->flush(!status);
+    }
+
+    return status;
+}
+
+template<class T>
+inline bool MhapParser<T>::parse(OverlapStore& dst, std::uint64_t max_bytes) {
+
+    this->open_batch();
+    auto status = parse_lines(max_bytes, -1, [&] (std::uint64_t a_id,
+        std::uint64_t b_id, double error, std::uint32_t,
+        std::uint32_t a_rc, std::uint32_t a_begin, std::uint32_t a_end,
+        std::uint32_t a_length, std::uint32_t b_rc, std::uint32_t b_begin,
+        std::uint32_t b_end, std::uint32_t b_length) -> void {
+
+        // one more than the largest id has to fit into 32 bits as well
+        for (auto id: {a_id, b_id}) {
+            if (id >= static_cast<std::uint32_t>(-1)) {
+                throw std::invalid_argument("[bioparser::MhapParser] error: "
+                    "read id " + std::to_string(id) + " does not fit into "
+                    "the overlap store!");
+            }
+        }
+
+        OverlapStore::Record record;
+        record.q_id = a_id;
+        record.q_length = a_length;
+        record.q_begin = a_begin;
+        record.q_end = a_end;
+        record.orientation = a_rc == b_rc ? '+' : '-';
+        record.t_id = b_id;
+        record.t_length = b_length;
+        record.t_begin = b_begin;
+        record.t_end = b_end;
+        record.block_length = std::max(a_end - a_begin, b_end - b_begin);
+        record.matching_bases = (1 - error) * record.block_length + 0.5;
+        record.mapping_quality = 255;
+        dst.add(record);
+        this->count(span(a_begin, a_end));
+    });
+
+    dst.merge(!status);
+    return status;
+}
+
+template<class T>
+template<class F>
+inline bool MhapParser<T>::parse_lines(std::uint64_t max_bytes,
+    std::uint32_t columns, F create) {
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    bool status = false;
+    std::uint64_t current_bytes = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    std::uint64_t last_object_id = num_objects;
+
+    const std::uint32_t kMhapObjectLength = 12;
+
+    char* line = &(this->storage_[0]);
+    std::uint32_t line_length = 0;
+
+    std::uint64_t a_id = 0, b_id = 0;
+    std::uint32_t a_rc = 0, a_begin = 0, a_end = 0, a_length = 0, b_rc = 0,
+        b_begin = 0, b_end = 0, b_length = 0, minmers = 0;
+    double error = 0;
+
+    // evaluated right after the last column a predicate needs
+    auto is_rejected = [&] (std::uint32_t column) -> bool {
+        switch (column) {
+            case 1: return filter_.remove_self_overlaps && a_id == b_id;
+            case 2: return 1 - error < filter_.min_identity;
+            case 10:
+                return std::max(a_end > a_begin ? a_end - a_begin : 0,
+                    b_end > b_begin ? b_end - b_begin : 0) < filter_.min_length;
+            default: return false;
+        }
+    };
+
+    auto create_T = [&] () -> void {
+        line[line_length] = 0;
+        rightStrip(line, line_length);
+
+        std::uint32_t num_values = 0, begin = 0;
+        bool is_dropped = false;
+        while (true) {
+            std::uint32_t end = begin;
+            for (std::uint32_t j = begin; j < line_length; ++j) {
+                if (line[j] == ' ') {
+                    end = j;
+                    break;
+                }
+            }
+            if (end == begin) {
+                end = line_length;
+            }
+            line[end] = 0;
+
+            if (!is_dropped && (columns >> num_values & 1)) {
+                switch (num_values) {
+                    case 0: a_id = atoll(&line[begin]); break;
+                    case 1: b_id = atoll(&line[begin]); break;
+                    case 2: error = atof(&line[begin]); break;
+                    case 3: minmers = atoi(&line[begin]); break;
+                    case 4: a_rc = atoi(&line[begin]); break;
+                    case 5: a_begin = atoi(&line[begin]); break;
+                    case 6: a_end = atoi(&line[begin]); break;
+                    case 7: a_length = atoi(&line[begin]); break;
+                    case 8: b_rc = atoi(&line[begin]); break;
+                    case 9: b_begin = atoi(&line[begin]); break;
+                    case 10: b_end = atoi(&line[begin]); break;
+                    case 11: b_length = atoi(&line[begin]); break;
+                    default: break;
+                }
+            }
+            // rejected records are not decoded further, their columns are
+            // still counted so that malformed lines are not dropped silently
+            if (is_filtered_ && !is_dropped && is_rejected(num_values)) {
+                is_dropped = true;
+            }
+            num_values++;
+            if (end == line_length || num_values == kMhapObjectLength) {
+                break;
+            }
+            begin = end + 1;
+        }
+
+        if (num_values != kMhapObjectLength) {
+            throw std::invalid_argument("[bioparser::MhapParser] error: "
+                "invalid file format!");
+        }
+        if (is_dropped) {
+            // rejected records count as parsed for chunking
+            ++num_objects;
+            current_bytes = 0;
+            line_length = 0;
+            return;
+        }
+
+        create(a_id, b_id, error, minmers, a_rc, a_begin, a_end, a_length,
+            b_rc, b_begin, b_end, b_length);
+
+        ++num_objects;
+        current_bytes = 0;
+        line_length = 0;
+    };
+
+    while (!is_end) {
+
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+
+        total_bytes += read_bytes;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (last_object_id == num_objects) {
+                throw ChunkSizeError("[bioparser::MhapParser] error: "
+                    "too small chunk size!");
+            }
+            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
+            status = true;
+            break;
+        }
+
+        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+
+            auto c = this->buffer_[i];
+            ++current_bytes;
+
+            if (c == '\n') {
+                create_T();
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i + 1, read_bytes);
+                    break;
+                }
+            } else {
+                line[line_length++] = c;
+            }
+        }
+
+        if (this->is_batch_full()) {
+            break;
+        }
+        if (is_end && current_bytes != 0) {
+            create_T();
+        }
+    }
+
+    return status;
+}
+
+template<class T>
+inline PafParser<T>::PafParser(gzFile input_file)
+        : Parser<T>(input_file, 3 * kSSS + kMSS),
+        names_(), filter_(), is_filtered_(false), projection_(-1) {
+}
+
+template<class T>
+inline void PafParser<T>::set_filter(const OverlapFilter& filter) {
+    filter_ = filter;
+    is_filtered_ = isActive(filter);
+}
+
+template<class T>
+inline void PafParser<T>::set_projection(
+    std::initializer_list<std::uint32_t> columns) {
+    projection_ = columnMask(columns);
+}
+
+template<class T>
+inline const std::shared_ptr<NameTable>& PafParser<T>::names() const {
+    // created on first use, parsers of T with names never need it
+    if (names_ == nullptr) {
+        names_ = std::make_shared<NameTable>();
+    }
+    return names_;
+}
+
+template<class T>
+inline void PafParser<T>::set_names(std::shared_ptr<NameTable> names) {
+    if (names == nullptr) {
+        throw std::invalid_argument("[bioparser::PafParser] error: "
+            "missing name table!");
+    }
+    names_ = std::move(names);
+}
+
+template<class T>
+inline T* PafParser<T>::createT(std::false_type, const char* q_name,
+    std::uint32_t q_name_length, std::uint32_t q_length,
+    std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+    const char* t_name, std::uint32_t t_name_length, std::uint32_t t_length,
+    std::uint32_t t_begin, std::uint32_t t_end, std::uint32_t matching_bases,
+    std::uint32_t overlap_length, std::uint32_t mapping_quality,
+    const char* tags, std::uint32_t tags_length) {
+
+    return construct(std::integral_constant<bool, usesTags()>(), tags,
+        tags_length, q_name, q_name_length, q_length, q_begin, q_end,
+        orientation, t_name, t_name_length, t_length, t_begin, t_end,
+        matching_bases, overlap_length, mapping_quality);
+}
+
+template<class T>
+template<class... Args>
+inline T* PafParser<T>::construct(std::true_type, const char* tags,
+    std::uint32_t tags_length, Args... args) {
+    return new T(args..., tags, tags_length);
+}
+
+template<class T>
+template<class... Args>
+inline T* PafParser<T>::construct(std::false_type, const char*, std::uint32_t,
+    Args... args) {
+    return new T(args...);
+}
+
+template<class T>
+inline T* PafParser<T>::createT(std::true_type, const char* q_name,
+    std::uint32_t q_name_length, std::uint32_t q_length,
+    std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+    const char* t_name, std::uint32_t t_name_length, std::uint32_t t_length,
+    std::uint32_t t_begin, std::uint32_t t_end, std::uint32_t matching_bases,
+    std::uint32_t overlap_length, std::uint32_t mapping_quality,
+    const char*, std::uint32_t) {
+
+    // ids are given in order of appearance
+    std::uint32_t q_id, t_id;
+    names()->intern(q_name, q_name_length, t_name, t_name_length, q_id, t_id);
+    return new T(q_id, q_length, q_begin, q_end, orientation, t_id, t_length,
+        t_begin, t_end, matching_bases, overlap_length, mapping_quality);
+}
+
+template<class T>
+inline PafParser<T>::~PafParser() {
+}
+
+template<class T>
+inline bool PafParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    // optional columns are not cached
+    this->open_batch();
+    if (!is_filtered_ && projection_ == static_cast<std::uint32_t>(-1) &&
+        !usesTags() &&
+        this->open_cache(trim ? "PafParser" : "PafParser,untrimmed")) {
+        return this->cache_->load(max_bytes,
+            [&] (const ParserCache::Record& record) -> bool {
+                auto u32 = [&] (std::uint32_t column) -> std::uint32_t {
+                    return record.value<std::uint32_t>(column);
+                };
+                dst.emplace_back(std::unique_ptr<T>(createT(
+                    std::integral_constant<bool, usesIds()>(),
+                    record.string(0), record.length(0),
+                    u32(1), u32(2), u32(3), record.value<char>(4),
+                    record.string(5), record.length(5),
+                    u32(6), u32(7), u32(8), u32(9), u32(10), u32(11),
+                    "", 0)));
+                this->count(span(u32(2), u32(3)), *dst.back(),
+                    usesIds() ? 0 : record.length(0) + record.length(5));
+                return this->is_batch_full();
+            });
+    }
+
+    // names are interned even if projected away, ids would be 0 otherwise
+    std::uint32_t columns = projection_ |
+        (is_filtered_ ? columnMask({0, 2, 3, 5, 7, 8, 9, 10, 11}) : 0) |
+        (this->limits_.max_bases != 0 ? columnMask({2, 3}) : 0) |
+        (usesIds() ? columnMask({0, 5}) : 0);
+
+    auto status = parse_lines(max_bytes, trim, columns, [&] (
+        const char* q_name, std::uint32_t q_name_length, std::uint32_t q_length,
+        std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+        const char* t_name, std::uint32_t t_name_length, std::uint32_t t_length,
+        std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char* tags,
+        std::uint32_t tags_length) -> void {
+
+        dst.emplace_back(std::unique_ptr<T>(createT(
+            std::integral_constant<bool, usesIds()>(), q_name, q_name_length,
+            q_length, q_begin, q_end, orientation, t_name, t_name_length,
+            t_length, t_begin, t_end, matching_bases, overlap_length,
+            mapping_quality, tags, tags_length)));
+        this->count(span(q_begin, q_end), *dst.back(),
+            usesIds() ? 0 : q_name_length + t_name_length +
+            (usesTags() ? tags_length : 0));
+
+        if (this->cache_ != nullptr) {
+            this->cache_->store(q_name, q_name_length, q_length, q_begin,
+                q_end, orientation, t_name, t_name_length, t_length, t_begin,
+                t_end, matching_bases, overlap_length, mapping_quality);
+        }
+    });
+
+    if (this->cache_ != nullptr) {
+        this->cache_->flush(!status);
+    }
+
+    return status;
+}
+
+template<class T>
+inline bool PafParser<T>::parse(OverlapStore& dst, std::uint64_t max_bytes,
+    bool trim) {
+
+    this->open_batch();
+
+    // stores are filled by one name table, share it with set_names to fill
+    // a store from several parsers
+    auto& names = this->names();
+    if (dst.names_ == nullptr) {
+        dst.names_ = names;
+    } else if (dst.names_ != names) {
+        throw std::invalid_argument("[bioparser::PafParser] error: "
+            "overlap store uses a different name table!");
+    }
+
+    auto status = parse_lines(max_bytes, trim, -1, [&] (
+        const char* q_name, std::uint32_t q_name_length, std::uint32_t q_length,
+        std::uint32_t q_begin, std::uint32_t q_end, char orientation,
+        const char* t_name, std::uint32_t t_name_length, std::uint32_t t_length,
+        std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char*, std::uint32_t) -> void {
+
+        OverlapStore::Record record;
+        names->intern(q_name, q_name_length, t_name, t_name_length,
+            record.q_id, record.t_id);
+        record.q_length = q_length;
+        record.q_begin = q_begin;
+        record.q_end = q_end;
+        record.orientation = orientation;
+        record.t_length = t_length;
+        record.t_begin = t_begin;
+        record.t_end = t_end;
+        record.matching_bases = matching_bases;
+        record.block_length = overlap_length;
+        record.mapping_quality = mapping_quality;
+        dst.add(record);
+        this->count(span(q_begin, q_end));
+    });
+
+    dst.merge(!status);
+    return status;
+}
+
+template<class T>
+template<class F>
+inline bool PafParser<T>::parse_lines(std::uint64_t max_bytes, bool trim,
+    std::uint32_t columns, F create) {
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    bool status = false;
+    std::uint64_t current_bytes = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    std::uint64_t last_object_id = num_objects;
+
+    const std::uint32_t kPafObjectLength = 12;
+
+    char* line = &(this->storage_[0]);
+    std::uint32_t line_length = 0;
+
+    const char* q_name = "", * t_name = "";
+    std::uint32_t tags_begin = 0;
+
+    std::uint32_t q_name_length = 0, q_length = 0, q_begin = 0, q_end = 0,
+        t_name_length = 0, t_length = 0, t_begin = 0, t_end = 0,
+        matching_bases = 0, overlap_length = 0, mapping_quality = 0;
+    char orientation = '\0';
+
+    // evaluated right after the last column a predicate needs
+    auto is_rejected = [&] (std::uint32_t column) -> bool {
+        switch (column) {
+            case 5:
+                return filter_.remove_self_overlaps &&
+                    q_name_length == t_name_length &&
+                    std::memcmp(q_name, t_name, q_name_length) == 0;
+            case 8:
+                return std::max(q_end > q_begin ? q_end - q_begin : 0,
+                    t_end > t_begin ? t_end - t_begin : 0) < filter_.min_length;
+            case 10:
+                return matching_bases < filter_.min_identity * overlap_length;
+            case 11: return mapping_quality < filter_.min_mapping_quality;
+            default: return false;
+        }
+    };
+
+    auto create_T = [&] () -> void {
+        line[line_length] = 0;
+        rightStrip(line, line_length);
+
+        std::uint32_t num_values = 0, begin = 0;
+        bool is_dropped = false;
+        while (true) {
+            std::uint32_t end = begin;
+            for (std::uint32_t j = begin; j < line_length; ++j) {
+                if (line[j] == '\t') {
+                    end = j;
+                    break;
+                }
+            }
+            if (end == begin) {
+                end = line_length;
+            }
+            line[end] = 0;
+
+            if (!is_dropped && (columns >> num_values & 1)) {
+                switch (num_values) {
+                    case 0:
+                        q_name = &line[begin];
+                        q_name_length = end - begin;
+                        break;
+                    case 1: q_length = atoi(&line[begin]); break;
+                    case 2: q_begin = atoi(&line[begin]); break;
+                    case 3: q_end = atoi(&line[begin]); break;
+                    case 4: orientation = line[begin]; break;
+                    case 5:
+                        t_name = &line[begin];
+                        t_name_length = end - begin;
+                        break;
+                    case 6: t_length = atoi(&line[begin]); break;
+                    case 7: t_begin = atoi(&line[begin]); break;
+                    case 8: t_end = atoi(&line[begin]); break;
+                    case 9: matching_bases = atoi(&line[begin]); break;
+                    case 10: overlap_length = atoi(&line[begin]); break;
+                    case 11: mapping_quality = atoi(&line[begin]); break;
+                    default: break;
+                }
+            }
+            // rejected records are not decoded further, their columns are
+            // still counted so that malformed lines are not dropped silently
+            if (is_filtered_ && !is_dropped && is_rejected(num_values)) {
+                is_dropped = true;
+            }
+            num_values++;
+            if (end == line_length || num_values == kPafObjectLength) {
+                tags_begin = std::min(end + 1, line_length);
+                break;
+            }
+            begin = end + 1;
+        }
+
+        if (num_values != kPafObjectLength) {
+            throw std::invalid_argument("[bioparser::PafParser] error: "
+                "invalid file format!");
+        }
+        if (is_dropped) {
+            // rejected records count as parsed for chunking
+            ++num_objects;
+            current_bytes = 0;
+            line_length = 0;
+            return;
+        }
+
+        q_name_length = std::min(q_name_length, kSSS);
+        t_name_length = std::min(t_name_length, kSSS);
+
+        if (trim) {
+            rightStripHard(q_name, q_name_length);
+            rightStripHard(t_name, t_name_length);
+        } else {
+            rightStrip(q_name, q_name_length);
+            rightStrip(t_name, t_name_length);
+        }
+
+        if ((q_name_length == 0 && (columns & 1U)) ||
+            (t_name_length == 0 && (columns >> 5 & 1U))) {
+            throw std::invalid_argument("[bioparser::PafParser] error: "
+                "invalid file format!");
+        }
+
+        create(q_name, q_name_length, q_length, q_begin, q_end, orientation,
+            t_name, t_name_length, t_length, t_begin, t_end, matching_bases,
+            overlap_length, mapping_quality, &line[tags_begin],
+            line_length - tags_begin);
+
+        ++num_objects;
+        current_bytes = 0;
+        line_length = 0;
+    };
+
+    while (!is_end) {
+
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+
+        total_bytes += read_bytes;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (last_object_id == num_objects) {
+                throw ChunkSizeError("[bioparser::PafParser] error: "
+                    "too small chunk size!");
+            }
+            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
+            status = true;
+            break;
+        }
+
+        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+
+            auto c = this->buffer_[i];
+            ++current_bytes;
+
+            if (c == '\n') {
+                create_T();
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i + 1, read_bytes);
+                    break;
+                }
+            } else {
+                line[line_length++] = c;
+                if (line_length == this->storage_.size()) {
+                    this->storage_.resize(3 * kSSS + kLSS);
+                    line = &(this->storage_[0]);
+                }
+            }
+        }
+
+        if (this->is_batch_full()) {
+            break;
+        }
+        if (is_end && current_bytes != 0) {
+            create_T();
+        }
+    }
+
+    return status;
+}
+
+template<class T>
+inline SamParser<T>::SamParser(gzFile input_file)
+        : Parser<T>(input_file, 5 * kSSS + 2 * kMSS), tags_(), cigar_(),
+        header_(), filter_(), is_filtered_(false), projection_(-1) {
+}
+
+template<class T>
+inline const SamHeader& SamParser<T>::header() const {
+    return header_;
+}
+
+template<class T>
+inline void SamParser<T>::set_filter(const OverlapFilter& filter) {
+    filter_ = filter;
+    is_filtered_ = isActive(filter);
+}
+
+template<class T>
+inline void SamParser<T>::set_projection(
+    std::initializer_list<std::uint32_t> columns) {
+    projection_ = columnMask(columns);
+}
+
+template<class T>
+inline T* SamParser<T>::createT(std::false_type, const char* q_name,
+    std::uint32_t q_name_length, std::uint32_t flag, const char* t_name,
+    std::uint32_t t_name_length, std::uint32_t, std::uint32_t t_begin,
+    std::uint32_t mapping_quality, const char* cigar,
+    std::uint32_t cigar_length, const char* t_next_name,
+    std::uint32_t t_next_name_length, std::uint32_t,
+    std::uint32_t t_next_begin, std::uint32_t template_length,
+    const char* sequence, std::uint32_t sequence_length,
+    const char* quality, std::uint32_t quality_length) {
+
+    return createT(std::integral_constant<int, signature()>(), q_name,
+        q_name_length, flag, t_name, t_name_length, t_begin, mapping_quality,
+        cigar, cigar_length, t_next_name, t_next_name_length, t_next_begin,
+        template_length, sequence, sequence_length, quality, quality_length);
+}
+
+template<class T>
+inline T* SamParser<T>::createT(std::true_type, const char* q_name,
+    std::uint32_t q_name_length, std::uint32_t flag, const char*,
+    std::uint32_t, std::uint32_t t_id, std::uint32_t t_begin,
+    std::uint32_t mapping_quality, const char* cigar,
+    std::uint32_t cigar_length, const char*, std::uint32_t,
+    std::uint32_t t_next_id, std::uint32_t t_next_begin,
+    std::uint32_t template_length, const char* sequence,
+    std::uint32_t sequence_length, const char* quality,
+    std::uint32_t quality_length) {
+
+    return createT(std::integral_constant<int, signature()>(), q_name,
+        q_name_length, flag, t_id, t_begin, mapping_quality, cigar,
+        cigar_length, t_next_id, t_next_begin, template_length, sequence,
+        sequence_length, quality, quality_length);
+}
+
+template<class T>
+template<class... Args>
+inline T* SamParser<T>::createT(std::integral_constant<int, 0>,
+    Args... args) {
+    return new T(args...);
+}
+
+template<class T>
+template<class... Args>
+inline T* SamParser<T>::createT(std::integral_constant<int, 1>,
+    Args... args) {
+    return new T(args..., static_cast<const SamTags&>(tags_));
+}
+
+template<class T>
+template<class... Args>
+inline T* SamParser<T>::createT(std::integral_constant<int, 2>,
+    Args... args) {
+    return new T(args..., static_cast<const SamCigar&>(cigar_));
+}
+
+template<class T>
+template<class... Args>
+inline T* SamParser<T>::createT(std::integral_constant<int, 3>,
+    Args... args) {
+    return new T(args..., static_cast<const SamCigar&>(cigar_),
+        static_cast<const SamTags&>(tags_));
+}
+
+template<class T>
+inline SamParser<T>::~SamParser() {
+}
+
+// @SQ lines are read again after a reset
+template<class T>
+inline void SamParser<T>::reset() {
+    Parser<T>::reset();
+    header_.clear();
+}
+
+template<class T>
+inline bool SamParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    auto input_file = this->input_file_.get();
+    bool is_end = this->is_eof();
+    bool status = false;
+    std::uint64_t current_bytes = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    std::uint64_t last_object_id = num_objects;
+
+    const std::uint32_t kSamObjectLength = 11;
+
+    std::uint32_t columns = projection_ |
+        (is_filtered_ ? columnMask({1, 4, 5}) : 0) |
+        (signature() > 1 ? columnMask({5}) : 0) |
+        (this->limits_.max_bases != 0 ? columnMask({9}) : 0);
+    this->open_batch();
+
+    char* line = &(this->storage_[0]);
+    std::uint32_t line_length = 0;
+    // end of the last mandatory column, optional fields follow
+    std::uint32_t columns_end = 0;
+
+    const char* q_name = "", * t_name = "", * cigar = "", * t_next_name = "",
+        * sequence = "", * quality = "";
+    // set once the filter has decoded the CIGAR of the current record
+    bool is_cigar_decoded = false;
+
+    std::uint32_t q_name_length = 0, flag = 0, t_name_length = 0, t_begin = 0,
+        mapping_quality = 0, cigar_length = 0, t_next_name_length = 0,
+        t_next_begin = 0, template_length = 0, sequence_length = 0,
+        quality_length = 0;
+
+    // evaluated right after the last column a predicate needs
+    auto is_rejected = [&] (std::uint32_t column) -> bool {
+        switch (column) {
+            case 1: return (flag & filter_.excluded_flags) != 0;
+            case 4: return mapping_quality < filter_.min_mapping_quality;
+            case 5:
+                if (filter_.min_length == 0) {
+                    return false;
+                }
+                rightStrip(cigar, cigar_length);
+                if (!cigar_.reset(cigar, cigar_length)) {
+                    throw std::invalid_argument("[bioparser::SamParser] "
+                        "error: invalid CIGAR!");
+                }
+                is_cigar_decoded = true;
+                return cigar_.target_span() < filter_.min_length;
+            default: return false;
+        }
+    };
+
+    auto reference_id = [&] (const char* name, std::uint32_t name_length)
+        -> std::uint32_t {
+
+        // '*' or a column left out of the projection
+        if (name_length == 0 || (name_length == 1 && name[0] == '*')) {
+            return -1;
+        }
+        std::uint32_t id = header_.id(name, name_length);
+        if (id == static_cast<std::uint32_t>(-1)) {
+            throw std::invalid_argument("[bioparser::SamParser] error: "
+                "reference " + std::string(name, name_length) +
+                " is missing from the header!");
+        }
+        return id;
+    };
+
+    auto create_T = [&] () -> void {
+
+        line[line_length] = 0;
+        rightStrip(line, line_length);
+        is_cigar_decoded = false;
+
+        std::uint32_t num_values = 0, begin = 0;
+        bool is_dropped = false;
+        while (true) {
+            std::uint32_t end = begin;
+            for (std::uint32_t j = begin; j < line_length; ++j) {
+                if (line[j] == '\t') {
+                    end = j;
+                    break;
+                }
+            }
+            if (end == begin) {
+                end = line_length;
+            }
+            line[end] = 0;
+
+            if (!is_dropped && (columns >> num_values & 1)) {
+                switch (num_values) {
+                    case 0:
+                        q_name = &line[begin];
+                        q_name_length = end - begin;
+                        break;
+                    case 1: flag = atoi(&line[begin]); break;
+                    case 2:
+                        t_name = &line[begin];
+                        t_name_length = end - begin;
+                        break;
+                    case 3: t_begin = atoi(&line[begin]); break;
+                    case 4: mapping_quality = atoi(&line[begin]); break;
+                    case 5:
+                        cigar = &line[begin];
+                        cigar_length = end - begin;
+                        break;
+                    case 6:
+                        t_next_name = &line[begin];
+                        t_next_name_length = end - begin;
+                        break;
+                    case 7: t_next_begin = atoi(&line[begin]); break;
+                    case 8: template_length = atoi(&line[begin]); break;
+                    case 9:
+                        sequence = &line[begin];
+                        sequence_length = end - begin;
+                        break;
+                    case 10:
+                        quality = &line[begin];
+                        quality_length = end - begin;
+                        break;
+                    default: break;
+                }
+            }
+            columns_end = end;
+            // rejected records are not decoded further, their columns are
+            // still counted so that malformed lines are not dropped silently
+            if (is_filtered_ && !is_dropped && is_rejected(num_values)) {
+                is_dropped = true;
+            }
+            num_values++;
+            if (end == line_length || num_values == kSamObjectLength) {
+                break;
+            }
+            begin = end + 1;
+        }
+
+        if (num_values != kSamObjectLength) {
+            throw std::invalid_argument("[bioparser::SamParser] error: "
+                "invalid file format!");
+        }
+        if (is_dropped) {
+            // rejected records count as parsed for chunking
+            ++num_objects;
+            current_bytes = 0;
+            line_length = 0;
+            return;
+        }
+
+        if (columns_end < line_length) {
+            tags_.reset(&line[columns_end + 1], line_length - columns_end - 1);
+        } else {
+            tags_.reset(nullptr, 0);
+        }
+
+        q_name_length = std::min(q_name_length, kSSS);
+        t_name_length = std::min(t_name_length, kSSS);
+        t_next_name_length = std::min(t_next_name_length, kSSS);
+
+        if (trim) {
+            rightStripHard(q_name, q_name_length);
+            rightStripHard(t_name, t_name_length);
+            rightStripHard(t_next_name, t_next_name_length);
+        } else {
+            rightStrip(q_name, q_name_length);
+            rightStrip(t_name, t_name_length);
+            rightStrip(t_next_name, t_next_name_length);
+        }
+
+        rightStrip(cigar, cigar_length);
+        rightStrip(sequence, sequence_length);
+        rightStrip(quality, quality_length);
+
+        // columns left out of the projection are empty
+        auto is_missing = [&] (std::uint32_t column, std::uint32_t length)
+            -> bool {
+            return length == 0 && (columns >> column & 1U);
+        };
+
+        if (is_missing(0, q_name_length) || is_missing(2, t_name_length) ||
+            is_missing(5, cigar_length) || is_missing(6, t_next_name_length) ||
+            is_missing(9, sequence_length) || is_missing(10, quality_length) ||
+            (sequence_length > 1 && quality_length > 1 &&
+            sequence_length != quality_length)) {
+
+            throw std::invalid_argument("[bioparser::SamParser] error: "
+                "invalid file format!");
+        }
+
+        if (signature() > 1 && !is_cigar_decoded &&
+            !cigar_.reset(cigar, cigar_length)) {
+            throw std::invalid_argument("[bioparser::SamParser] error: "
+                "invalid CIGAR!");
+        }
+
+        std::uint32_t t_id = -1, t_next_id = -1;
+        if (usesIds()) {
+            t_id = reference_id(t_name, t_name_length);
+            t_next_id = t_next_name_length == 1 && t_next_name[0] == '=' ?
+                t_id : reference_id(t_next_name, t_next_name_length);
+        }
+
+        dst.emplace_back(std::unique_ptr<T>(createT(
+            std::integral_constant<bool, usesIds()>(), q_name, q_name_length,
+            flag, t_name, t_name_length, t_id, t_begin, mapping_quality,
+            cigar, cigar_length, t_next_name, t_next_name_length, t_next_id,
+            t_next_begin, template_length, sequence, sequence_length,
+            quality, quality_length)));
+        // '*' if the sequence is not stored
+        this->count(sequence_length == 1 && sequence[0] == '*' ?
+            0 : sequence_length, *dst.back(), q_name_length + t_name_length +
+            cigar_length + t_next_name_length + sequence_length +
+            quality_length);
+
+        ++num_objects;
+        current_bytes = 0;
+        line_length = 0;
+    };
+
+    while (!is_end) {
+
+        std::uint64_t read_bytes = this->read_block();
+        is_end = gzeof(input_file);
+
+        total_bytes += read_bytes;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (last_object_id == num_objects) {
+                throw ChunkSizeError("[bioparser::SamParser] error: "
+                    "too small chunk size!");
+            }
+            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
+            status = true;
+            break;
+        }
+
+        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+
+            auto c = this->buffer_[i];
+            ++current_bytes;
+
+            if (c == '\n') {
+                if (line[0] == '@') {
+                    header_.parse(line, line_length);
+                    line_length = 0;
+                    current_bytes = 0;
+                    continue;
+                }
+                create_T();
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i + 1, read_bytes);
+                    break;
+                }
+            } else {
+                line[line_length++] = c;
+                if (line_length == this->storage_.size()) {
+                    this->storage_.resize(5 * kSSS + 2 * kLSS);
+                    line = &(this->storage_[0]);
+                }
+            }
+        }
+
+        if (this->is_batch_full()) {
+            break;
+        }
+        if (is_end && current_bytes != 0) {
+            create_T();
+        }
+    }
+
+    return status;
+}
+
+template<class T>
+inline BamParser<T>::BamParser(std::FILE* input_file)
+        : Parser<T>(nullptr, kSSS), bam_file_(input_file, std::fclose),
+        num_threads_(std::max(std::thread::hardware_concurrency(), 1U)),
+        is_eof_(false), is_header_parsed_(false), blocks_(), data_(),
+        data_begin_(0), header_() {
+}
+
+template<class T>
+inline BamParser<T>::~BamParser() {
+}
+
+template<class T>
+inline const SamHeader& BamParser<T>::header() const {
+    return header_;
+}
+
+template<class T>
+inline void BamParser<T>::reset() {
+    std::fseek(this->bam_file_.get(), 0, SEEK_SET);
+    is_eof_ = false;
+    is_header_parsed_ = false;
+    data_.clear();
+    data_begin_ = 0;
+    header_.clear();
+}
+
+template<class T>
+inline bool BamParser<T>::inflate_blocks() {
+
+    // BGZF block: gzip member with a 'BC' extra subfield holding its size
+    const std::uint32_t kBgzfHeaderLength = 12;
+    const std::uint32_t kBgzfFooterLength = 8;
+
+    struct Block {
+        std::uint64_t begin;
+        std::uint32_t length;
+        std::uint64_t output_begin;
+        std::uint32_t output_length;
+        std::uint32_t crc;
+    };
+    std::vector<Block> blocks;
+
+    auto input_file = bam_file_.get();
+    std::uint64_t output_length = 0;
+    blocks_.clear();
+
+    while (!is_eof_ && blocks.size() < kBgzfBatchSize) {
+        char header[kBgzfHeaderLength];
+        auto read_bytes = std::fread(header, 1, kBgzfHeaderLength, input_file);
+        if (read_bytes == 0) {
+            is_eof_ = true;
+            break;
+        }
+        if (read_bytes != kBgzfHeaderLength ||
+            (std::uint8_t) header[0] != 31 || (std::uint8_t) header[1] != 139 ||
+            header[2] != 8 || (header[3] & 4) == 0) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        std::uint32_t extra_length = readLittleEndian16(&header[10]);
+        char extra[0xFFFF];
+        if (std::fread(extra, 1, extra_length, input_file) != extra_length) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        std::uint32_t block_length = 0;
+        for (std::uint32_t i = 0; i + 4 <= extra_length;) {
+            std::uint32_t subfield_length = readLittleEndian16(&extra[i + 2]);
+            if (extra[i] == 'B' && extra[i + 1] == 'C' &&
+                subfield_length == 2) {
+                block_length = readLittleEndian16(&extra[i + 4]) + 1;
+                break;
+            }
+            i += 4 + subfield_length;
+        }
+        if (block_length <
+            kBgzfHeaderLength + extra_length + kBgzfFooterLength) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        std::uint32_t data_length =
+            block_length - kBgzfHeaderLength - extra_length;
+        auto begin = blocks_.size();
+        blocks_.resize(begin + data_length);
+        if (std::fread(&blocks_[begin], 1, data_length, input_file) !=
+            data_length) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        const char* footer = &blocks_[begin + data_length - kBgzfFooterLength];
+        std::uint32_t crc = readLittleEndian32(footer);
+        std::uint32_t isize = readLittleEndian32(&footer[4]);
+        if (isize != 0) {
+            blocks.push_back({begin, data_length - kBgzfFooterLength,
+                output_length, isize, crc});
+            output_length += isize;
+        }
+    }
+
+    if (blocks.empty()) {
+        return !is_eof_;
+    }
+
+    auto output_begin = data_.size();
+    data_.resize(output_begin + output_length);
+
+    std::atomic<std::uint32_t> next_block(0);
+    std::atomic<bool> is_valid(true);
+
+    auto inflate_block = [&] () -> void {
+        for (std::uint32_t i = next_block++; i < blocks.size();
+            i = next_block++) {
+            const auto& block = blocks[i];
+            auto dst = reinterpret_cast<Bytef*>(
+                &data_[output_begin + block.output_begin]);
+
+            z_stream stream;
+            stream.zalloc = Z_NULL;
+            stream.zfree = Z_NULL;
+            stream.opaque = Z_NULL;
+            stream.next_in = reinterpret_cast<Bytef*>(&blocks_[block.begin]);
+            stream.avail_in = block.length;
+            stream.next_out = dst;
+            stream.avail_out = block.output_length;
+
+            if (inflateInit2(&stream, -15) != Z_OK) {
+                is_valid = false;
+                continue;
+            }
+            auto ret = inflate(&stream, Z_FINISH);
+            inflateEnd(&stream);
+
+            if (ret != Z_STREAM_END ||
+                stream.total_out != block.output_length ||
+                crc32(crc32(0L, Z_NULL, 0), dst, block.output_length) !=
+                block.crc) {
+                is_valid = false;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    auto num_threads = std::min<std::uint64_t>(num_threads_, blocks.size());
+    for (std::uint32_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(inflate_block);
+    }
+    inflate_block();
+    for (auto& it: threads) {
+        it.join();
+    }
+
+    if (!is_valid) {
+        throw std::invalid_argument("[bioparser::BamParser] error: "
+            "invalid file format!");
+    }
+
+    return true;
+}
+
+template<class T>
+inline bool BamParser<T>::fill(std::uint64_t num_bytes) {
+    while (data_.size() - data_begin_ < num_bytes) {
+        if (data_begin_ != 0) {
+            data_.erase(data_.begin(), data_.begin() + data_begin_);
+            data_begin_ = 0;
+        }
+        if (!inflate_blocks()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class T>
+inline void BamParser<T>::parse_header() {
+
+    auto require = [&] (std::uint64_t num_bytes) -> const char* {
+        if (!fill(num_bytes)) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+        return &data_[data_begin_];
+    };
+
+    auto header = require(8);
+    if (header[0] != 'B' || header[1] != 'A' || header[2] != 'M' ||
+        header[3] != 1) {
+        throw std::invalid_argument("[bioparser::BamParser] error: "
+            "invalid file format!");
+    }
+    std::uint32_t text_length = readLittleEndian32(&header[4]);
+    data_begin_ += 8;
+    require(text_length + 4);
+    data_begin_ += text_length;
+
+    std::uint32_t num_references = readLittleEndian32(require(4));
+    data_begin_ += 4;
+    for (std::uint32_t i = 0; i < num_references; ++i) {
+        std::uint32_t name_length = readLittleEndian32(require(4));
+        auto name = require(4 + name_length + 4) + 4;
+        // names are stored with their null terminator
+        std::uint32_t reference_length = name_length > 0 ? name_length - 1 : 0;
+        if (!header_.add(name, reference_length,
+            readLittleEndian32(name + name_length))) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "duplicate reference " + std::string(name, reference_length) +
+                " in the header!");
+        }
+        data_begin_ += 4 + name_length + 4;
+    }
+
+    is_header_parsed_ = true;
+}
+
+template<class T>
+inline bool BamParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
     std::uint64_t max_bytes, bool trim) {
 
+    if (!is_header_parsed_) {
+        parse_header();
+    }
+
+    bool status = false;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t num_objects = 0;
+    this->open_batch();
+
+    const std::uint32_t kBamObjectLength = 32;
+    const char* kCigarOperations = "MIDNSHP=X";
+    const char* kBases = "=ACMGRSVTWYHKDBN";
+
+    const char* q_name = nullptr, * t_name = nullptr, * t_next_name = nullptr;
+    char* cigar = nullptr, * sequence = nullptr, * quality = nullptr;
+
+    std::uint32_t q_name_length = 0, flag = 0, t_name_length = 0, t_begin = 0,
+        mapping_quality = 0, cigar_length = 0, t_next_name_length = 0,
+        t_next_begin = 0, template_length = 0, sequence_length = 0,
+        quality_length = 0;
+
+    auto reference_name = [&] (std::int32_t id, const char*& name,
+        std::uint32_t& name_length) -> void {
+
+        if (id < 0) {
+            name = "*";
+            name_length = 1;
+        } else if ((std::uint32_t) id < header_.size()) {
+            name = header_.name(id).c_str();
+            name_length = header_.name(id).size();
+        } else {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+    };
+
+    // returns the size of the tag value starting at src (type included)
+    auto tag_size = [&] (const char* src, const char* end) -> std::uint64_t {
+        switch (src[0]) {
+            case 'A': case 'c': case 'C': return 2;
+            case 's': case 'S': return 3;
+            case 'i': case 'I': case 'f': return 5;
+            case 'Z': case 'H': {
+                auto it = std::find(src + 1, end, '\0');
+                return it == end ? end - src + 1 : it - src + 1;
+            }
+            case 'B': {
+                if (end - src < 6) {
+                    return end - src + 1;
+                }
+                std::uint64_t element_size =
+                    src[1] == 'c' || src[1] == 'C' ? 1 :
+                    (src[1] == 's' || src[1] == 'S' ? 2 : 4);
+                return 6 + element_size * readLittleEndian32(&src[2]);
+            }
+            default: return end - src + 1;
+        }
+    };
+
+    while (fill(4)) {
+        std::uint32_t block_size = readLittleEndian32(&data_[data_begin_]);
+        if (block_size < kBamObjectLength ||
+            !fill(4 + (std::uint64_t) block_size)) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        if (max_bytes != 0 && total_bytes + 4 + block_size > max_bytes) {
+            if (num_objects == 0) {
+                throw ChunkSizeError("[bioparser::BamParser] error: "
+                    "too small chunk size!");
+            }
+            status = true;
+            break;
+        }
+
+        const char* record = &data_[data_begin_ + 4];
+        const char* record_end = record + block_size;
+
+        std::int32_t t_id = readLittleEndian32(&record[0]);
+        std::int32_t t_next_id = readLittleEndian32(&record[20]);
+        t_begin = readLittleEndian32(&record[4]) + 1;
+        q_name_length = (std::uint8_t) record[8];
+        mapping_quality = (std::uint8_t) record[9];
+        std::uint32_t num_cigar_operations = readLittleEndian16(&record[12]);
+        flag = readLittleEndian16(&record[14]);
+        std::uint32_t l_seq = readLittleEndian32(&record[16]);
+        t_next_begin = readLittleEndian32(&record[24]) + 1;
+        template_length = readLittleEndian32(&record[28]);
+
+        const char* record_cigar = record + kBamObjectLength + q_name_length;
+        const char* record_sequence = record_cigar + 4 * num_cigar_operations;
+        const char* record_quality = record_sequence + (l_seq + 1) / 2;
+        const char* record_tags = record_quality + l_seq;
+        if (q_name_length == 0 || record_tags > record_end) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        // CIGARs with more than 65535 operations are stored in the CG tag
+        if (num_cigar_operations == 2 &&
+            (readLittleEndian32(record_cigar) & 0xF) == 4 &&
+            (readLittleEndian32(record_cigar) >> 4) == l_seq &&
+            (readLittleEndian32(record_cigar + 4) & 0xF) == 3) {
+
+            for (const char* it = record_tags; it + 3 <= record_end;) {
+                if (it[0] == 'C' && it[1] == 'G' && it[2] == 'B' &&
+                    it + 8 <= record_end && it[3] == 'I') {
+                    num_cigar_operations = readLittleEndian32(&it[4]);
+                    record_cigar = it + 8;
+                    if (record_cigar +
+                        4 * (std::uint64_t) num_cigar_operations > record_end) {
+                        throw std::invalid_argument("[bioparser::BamParser] "
+                            "error: invalid file format!");
+                    }
+                    break;
+                }
+                it += 2 + tag_size(it + 2, record_end);
+            }
+        }
+
+        std::uint64_t storage_size = kSSS +
+            11 * (std::uint64_t) num_cigar_operations +
+            2 * (std::uint64_t) l_seq + 2;
+        if (this->storage_.size() < storage_size) {
+            this->storage_.resize(storage_size);
+        }
+
+        q_name = record + kBamObjectLength;
+        --q_name_length;
+        q_name_length = std::min(q_name_length, kSSS);
+
+        reference_name(t_id, t_name, t_name_length);
+        if (t_next_id >= 0 && t_next_id == t_id) {
+            t_next_name = "=";
+            t_next_name_length = 1;
+        } else {
+            reference_name(t_next_id, t_next_name, t_next_name_length);
+        }
+        t_name_length = std::min(t_name_length, kSSS);
+        t_next_name_length = std::min(t_next_name_length, kSSS);
+
+        if (trim) {
+            rightStripHard(q_name, q_name_length);
+            rightStripHard(t_name, t_name_length);
+            rightStripHard(t_next_name, t_next_name_length);
+        } else {
+            rightStrip(q_name, q_name_length);
+            rightStrip(t_name, t_name_length);
+            rightStrip(t_next_name, t_next_name_length);
+        }
+
+        cigar = &(this->storage_[0]);
+        cigar_length = 0;
+        if (num_cigar_operations == 0) {
+            cigar[cigar_length++] = '*';
+        }
+        for (std::uint32_t i = 0; i < num_cigar_operations; ++i) {
+            std::uint32_t operation = readLittleEndian32(&record_cigar[4 * i]);
+            char digits[10];
+            std::uint32_t num_digits = 0;
+            std::uint32_t operation_length = operation >> 4;
+            do {
+                digits[num_digits++] = '0' + operation_length % 10;
+                operation_length /= 10;
+            } while (operation_length != 0);
+            while (num_digits > 0) {
+                cigar[cigar_length++] = digits[--num_digits];
+            }
+            cigar[cigar_length++] = (operation & 0xF) < 9 ?
+                kCigarOperations[operation & 0xF] : '?';
+        }
+
+        sequence = cigar + cigar_length;
+        quality = sequence + std::max(l_seq, 1U);
+        if (l_seq == 0) {
+            sequence[0] = '*';
+            sequence_length = 1;
+            quality[0] = '*';
+            quality_length = 1;
+        } else {
+            for (std::uint32_t i = 0; i < l_seq / 2; ++i) {
+                auto c = (std::uint8_t) record_sequence[i];
+                sequence[2 * i] = kBases[c >> 4];
+                sequence[2 * i + 1] = kBases[c & 0xF];
+            }
+            if (l_seq & 1) {
+                sequence[l_seq - 1] =
+                    kBases[(std::uint8_t) record_sequence[l_seq / 2] >> 4];
+            }
+            sequence_length = l_seq;
+
+            if ((std::uint8_t) record_quality[0] == 0xFF) {
+                quality[0] = '*';
+                quality_length = 1;
+            } else {
+                for (std::uint32_t i = 0; i < l_seq; ++i) {
+                    quality[i] = record_quality[i] + 33;
+                }
+                quality_length = l_seq;
+            }
+        }
+
+        if (q_name_length == 0 || t_name_length == 0 ||
+            t_next_name_length == 0) {
+            throw std::invalid_argument("[bioparser::BamParser] error: "
+                "invalid file format!");
+        }
+
+        dst.emplace_back(std::unique_ptr<T>(new T(q_name, q_name_length,
+            flag, t_name, t_name_length, t_begin, mapping_quality,
+            (const char*) cigar, cigar_length, t_next_name, t_next_name_length,
+            t_next_begin, template_length, (const char*) sequence,
+            sequence_length, (const char*) quality, quality_length)));
+
+        ++num_objects;
+        total_bytes += 4 + block_size;
+        data_begin_ += 4 + block_size;
+
+        this->count(l_seq, *dst.back(), q_name_length + t_name_length +
+            cigar_length + t_next_name_length + sequence_length +
+            quality_length);
+        if (this->is_batch_full()) {
+            status = fill(4);
+            break;
+        }
+    }
+
+    if (!status && data_begin_ != data_.size()) {
+        throw std::invalid_argument("[bioparser::BamParser] error: "
+            "invalid file format!");
+    }
+
+    return status;
+}
+
+template<class T>
+inline GfaParser<T>::GfaParser(gzFile input_file)
+        : Parser<T>(input_file, kMSS), skip_sequences_(false), is_gfa2_(false) {
+}
+
+template<class T>
+inline GfaParser<T>::~GfaParser() {
+}
+
+template<class T>
+inline void GfaParser<T>::reset() {
+    Parser<T>::reset();
+    is_gfa2_ = false;
+}
+
+template<class T>
+inline void GfaParser<T>::set_skip_sequences(bool skip_sequences) {
+    skip_sequences_ = skip_sequences;
+}
+
+template<class T>
+inline void GfaParser<T>::createPath(std::vector<std::unique_ptr<T>>& dst,
+    const char** values, const std::uint32_t* lengths, std::true_type) {
+
+    dst.emplace_back(std::unique_ptr<T>(new T(values[1], lengths[1],
+        values[2], lengths[2], values[3], lengths[3])));
+}
+
+template<class T>
+inline void GfaParser<T>::createEdge(std::vector<std::unique_ptr<T>>& dst,
+    const char** values, const std::uint32_t* lengths, std::true_type) {
+
+    dst.emplace_back(std::unique_ptr<T>(new T(values[1], lengths[1],
+        values[2], lengths[2] - 1, values[2][lengths[2] - 1],
+        values[3], lengths[3] - 1, values[3][lengths[3] - 1],
+        (std::uint32_t) atoi(values[4]), (std::uint32_t) atoi(values[5]),
+        (std::uint32_t) atoi(values[6]), (std::uint32_t) atoi(values[7]),
+        values[8], lengths[8])));
+}
+
+template<class T>
+inline bool GfaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool) {
+
     auto input_file = this->input_file_.get();
-    bool is_end = gzeof(input_file);
-    bool is_valid = false;
+    bool is_end = this->is_eof();
     bool status = false;
     std::uint64_t current_bytes = 0;
     std::uint64_t total_bytes = 0;
     std::uint64_t num_objects = 0;
     std::uint64_t last_object_id = num_objects;
-    std::uint32_t line_number = 0;
 
-    char* name = &(this->storage_[0]);
-    std::uint32_t name_length = 0;
+    const std::uint32_t kGfaObjectLength = 9;
+    const char* values[kGfaObjectLength];
+    std::uint32_t lengths[kGfaObjectLength];
 
-    char* sequence = &(this->storage_[kSSS]);
-    std::uint32_t sequence_length = 0;
+    using HasPath = decltype(hasPathConstructor<T>(0));
+    using HasEdge = decltype(hasEdgeConstructor<T>(0));
+
+    this->open_batch();
+
+    char* line = &(this->storage_[0]);
+    std::uint32_t line_length = 0;
+
+    // state of sequence skipping inside of S lines
+    std::uint32_t num_tabs = 0;
+    bool is_skipping = false;
+
+    auto reserve = [&] (std::uint64_t length) -> void {
+        if (length >= this->storage_.size()) {
+            this->storage_.resize(std::max<std::uint64_t>(
+                2 * this->storage_.size(), length + 1));
+            line = &(this->storage_[0]);
+        }
+    };
+
+    auto is_valid_orientation = [] (char c) -> bool {
+        return c == '+' || c == '-';
+    };
 
     auto create_T = [&] () -> void {
-        if (trim) {
-            rightStripHard(name, name_length);
-        } else {
-            rightStrip(name, name_length);
+        line[line_length] = 0;
+        rightStrip(line, line_length);
+
+        std::uint32_t num_values = 0;
+        if (line_length != 0 && line[0] != '#') {
+            std::uint32_t begin = 0;
+            while (num_values < kGfaObjectLength) {
+                auto it = static_cast<const char*>(std::memchr(&line[begin],
+                    '\t', line_length - begin));
+                std::uint32_t end = it == nullptr ? line_length : it - line;
+                values[num_values] = &line[begin];
+                lengths[num_values] = end - begin;
+                ++num_values;
+                if (end == line_length) {
+                    break;
+                }
+                begin = end + 1;
+            }
+            if (lengths[0] != 1) {
+                throw std::invalid_argument("[bioparser::GfaParser] error: "
+                    "invalid file format!");
+            }
         }
-        rightStrip(sequence, sequence_length);
 
-        if (name_length == 0 || name[0] != '>' || sequence_length == 0) {
-            throw std::invalid_argument("[bioparser::FastaParser] error: "
-                "invalid file format!");
+        bool is_valid = true;
+        switch (num_values == 0 ? '\0' : line[0]) {
+            case 'H':
+                if (std::strstr(line, "VN:Z:2") != nullptr) {
+                    is_gfa2_ = true;
+                }
+                break;
+            case 'S': {
+                // GFA2 segments have the length column before the sequence
+                std::uint32_t sequence_id = is_gfa2_ ? 3 : 2;
+                if (num_values <= sequence_id || lengths[1] == 0) {
+                    is_valid = false;
+                    break;
+                }
+                dst.emplace_back(std::unique_ptr<T>(new T(
+                    values[1], lengths[1],
+                    values[sequence_id],
+                    skip_sequences_ ? 0 : lengths[sequence_id])));
+                ++num_objects;
+                this->count(skip_sequences_ ? 0 : lengths[sequence_id],
+                    *dst.back(), lengths[1] +
+                    (skip_sequences_ ? 0 : lengths[sequence_id]));
+                break;
+            }
+            case 'L':
+                if (num_values < 6 || lengths[1] == 0 || lengths[3] == 0 ||
+                    lengths[2] != 1 || !is_valid_orientation(values[2][0]) ||
+                    lengths[4] != 1 || !is_valid_orientation(values[4][0])) {
+                    is_valid = false;
+                    break;
+                }
+                dst.emplace_back(std::unique_ptr<T>(new T(
+                    values[1], lengths[1], values[2][0],
+                    values[3], lengths[3], values[4][0],
+                    values[5], lengths[5])));
+                ++num_objects;
+                this->count(0, *dst.back(), lengths[1] + lengths[3] +
+                    lengths[5]);
+                break;
+            case 'P':
+                if (!HasPath::value) {
+                    break;
+                }
+                if (num_values < 4 || lengths[1] == 0 || lengths[2] == 0) {
+                    is_valid = false;
+                    break;
+                }
+                createPath(dst, values, lengths, HasPath());
+                ++num_objects;
+                this->count(0, *dst.back(), lengths[1] + lengths[2] +
+                    lengths[3]);
+                break;
+            case 'E':
+                if (!HasEdge::value) {
+                    break;
+                }
+                if (num_values < 9 || lengths[2] < 2 || lengths[3] < 2 ||
+                    !is_valid_orientation(values[2][lengths[2] - 1]) ||
+                    !is_valid_orientation(values[3][lengths[3] - 1])) {
+                    is_valid = false;
+                    break;
+                }
+                createEdge(dst, values, lengths, HasEdge());
+                ++num_objects;
+                this->count(0, *dst.back(), lengths[1] + lengths[2] +
+                    lengths[3] + lengths[8]);
+                break;
+            default:
+                // comments, containments, walks and other GFA2 lines
+                break;
         }
 
-        dst.emplace_back(std::unique_ptr<T>(new T(
-            (const char*) &(name[1]), name_length - 1,
-            (const char*) sequence, sequence_length)));
+        if (!is_valid) {
+            throw std::invalid_argument("[bioparser::GfaParser] error: "
+                "invalid file format!");
+        }
 
-        ++num_objects;
-        current_bytes = 1;
-        name_length = 1;
-        sequence_length = 0;
-        is_valid = false;
+        current_bytes = 0;
+        line_length = 0;
+        num_tabs = 0;
+        is_skipping = false;
     };
 
     while (!is_end) {
 
-        std::uint64_t read_bytes = gzfread(this->buffer_.data(), sizeof(char),
-            this->buffer_.size(), input_file);
+        std::uint64_t read_bytes = this->read_block();
         is_end = gzeof(input_file);
 
         total_bytes += read_bytes;
         if (max_bytes != 0 && total_bytes > max_bytes) {
             if (last_object_id == num_objects) {
-                throw std::invalid_argument("[bioparser::FastaParser] error: "
+                throw ChunkSizeError("[bioparser::GfaParser] error: "
                     "too small chunk size!");
             }
             gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
@@ -314,41 +5584,69 @@ inline bool FastaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
             break;
         }
 
-        for (std::uint32_t i = 0; i < read_bytes; ++i) {
-            auto c = this->buffer_[i];
+        const char* buffer = this->buffer_.data();
+        for (std::uint32_t i = 0; i < read_bytes;) {
 
-            if (c == '\n') {
-                ++line_number;
-            } else if (c == '>' && line_number != 0) {
-                is_valid = true;
-                line_number = 0;
-            } else {
-                switch (line_number) {
-                    case 0:
-                        if (name_length < kSSS) {
-                            if (!(name_length == 0 && isspace(c))) {
-                                name[name_length++] = c;
-                            }
-                        }
-                        break;
-                    default:
-                        sequence[sequence_length++] = c;
-                        if (sequence_length == kMSS) {
-                            this->storage_.resize(kSSS + kLSS, 0);
-                            name = &(this->storage_[0]);
-                            sequence = &(this->storage_[kSSS]);
-                        }
+            if (is_skipping) {
+                std::uint32_t j = i;
+                while (j < read_bytes &&
+                    buffer[j] != '\t' && buffer[j] != '\n') {
+                    ++j;
+                }
+                current_bytes += j - i;
+                is_skipping = j == read_bytes;
+                i = j;
+                continue;
+            }
+
+            // copy leading columns of S lines one by one to find the sequence
+            if (skip_sequences_ && num_tabs < (is_gfa2_ ? 3U : 2U) &&
+                (line_length == 0 ? buffer[i] : line[0]) == 'S') {
+
+                auto c = buffer[i++];
+                ++current_bytes;
+                if (c == '\n') {
+                    create_T();
+                    if (this->is_batch_full()) {
+                        status = this->keep_block(i, read_bytes);
                         break;
+                    }
+                    continue;
+                }
+                reserve(line_length + 2);
+                line[line_length++] = c;
+                if (c == '\t' && ++num_tabs == (is_gfa2_ ? 3U : 2U)) {
+                    // skipped sequence is kept as an absent one
+                    line[line_length++] = '*';
+                    is_skipping = true;
                 }
+                continue;
             }
 
-            ++current_bytes;
+            auto it = static_cast<const char*>(std::memchr(&buffer[i], '\n',
+                read_bytes - i));
+            std::uint32_t j = it == nullptr ? read_bytes : it - buffer;
 
-            if (is_valid) {
+            reserve(line_length + (j - i));
+            std::memcpy(&line[line_length], &buffer[i], j - i);
+            line_length += j - i;
+            current_bytes += j - i;
+            i = j;
+
+            if (it != nullptr) {
+                ++current_bytes;
+                ++i;
                 create_T();
+                if (this->is_batch_full()) {
+                    status = this->keep_block(i, read_bytes);
+                    break;
+                }
             }
         }
 
+        if (this->is_batch_full()) {
+            break;
+        }
         if (is_end && current_bytes != 0) {
             create_T();
         }
@@ -358,219 +5656,416 @@ inline bool FastaParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
 }
 
 template<class T>
-inline FastqParser<T>::FastqParser(gzFile input_file)
-        : Parser<T>(input_file, kSSS + 2 * kMSS) {
+inline TwoBitParser<T>::TwoBitParser(std::FILE* input_file)
+        : Parser<T>(nullptr, kSSS), two_bit_file_(input_file, std::fclose),
+        is_swapped_(false), is_index_parsed_(false), names_(), offsets_(),
+        ids_(), sequence_id_(0), records_(), packed_() {
 }
 
 template<class T>
-inline FastqParser<T>::~FastqParser() {
+inline TwoBitParser<T>::~TwoBitParser() {
 }
 
 template<class T>
-inline bool FastqParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
-    std::uint64_t max_bytes, bool trim) {
+inline void TwoBitParser<T>::reset() {
+    sequence_id_ = 0;
+}
 
-    auto input_file = this->input_file_.get();
-    bool is_end = gzeof(input_file);
-    bool is_valid = false;
-    bool status = false;
-    std::uint64_t current_bytes = 0;
-    std::uint64_t total_bytes = 0;
-    std::uint64_t num_objects = 0;
-    std::uint64_t last_object_id = num_objects;
-    std::uint32_t line_number = 0;
+template<class T>
+inline std::uint32_t TwoBitParser<T>::read32() {
+    char src[4];
+    if (std::fread(src, 1, 4, two_bit_file_.get()) != 4) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
+    auto value = readLittleEndian32(src);
+    if (is_swapped_) {
+        value = (value >> 24) | ((value >> 8) & 0xFF00) |
+            ((value << 8) & 0xFF0000) | (value << 24);
+    }
+    return value;
+}
 
-    char* name = &(this->storage_[0]);
-    std::uint32_t name_length = 0;
+template<class T>
+inline void TwoBitParser<T>::parse_index() {
 
-    char* sequence = &(this->storage_[kSSS]);
-    std::uint32_t sequence_length = 0;
+    if (is_index_parsed_) {
+        return;
+    }
 
-    char* quality = &(this->storage_[kSSS + kMSS]);
-    std::uint32_t quality_length = 0;
+    const std::uint32_t kSignature = 0x1A412743;
 
-    auto create_T = [&] () -> void {
-        if (trim) {
-            rightStripHard(name, name_length);
-        } else {
-            rightStrip(name, name_length);
-        }
-        rightStrip(sequence, sequence_length);
-        rightStrip(quality, quality_length);
+    const std::uint32_t kSwappedSignature = 0x4327411A;
 
-        if (name_length == 0 || name[0] != '@' || sequence_length == 0 ||
-            quality_length == 0 || sequence_length != quality_length) {
-            throw std::invalid_argument("[bioparser::FastqParser] error: "
+    std::fseek(two_bit_file_.get(), 0, SEEK_SET);
+    auto signature = read32();
+    if (signature == kSwappedSignature) {
+        is_swapped_ = true;
+    } else if (signature != kSignature) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
+
+    // version 1 stores 64-bit offsets
+    auto version = read32();
+    if (version > 1) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
+    auto num_sequences = read32();
+    read32();
+
+    names_.reserve(num_sequences);
+    offsets_.reserve(num_sequences);
+    for (std::uint32_t i = 0; i < num_sequences; ++i) {
+        std::uint8_t name_length = 0;
+        char name[256];
+        if (std::fread(&name_length, 1, 1, two_bit_file_.get()) != 1 ||
+            std::fread(name, 1, name_length, two_bit_file_.get()) !=
+                name_length) {
+            throw std::invalid_argument("[bioparser::TwoBitParser] error: "
                 "invalid file format!");
         }
+        names_.emplace_back(name, name_length);
+        std::uint64_t offset = read32();
+        if (version == 1) {
+            offset = is_swapped_ ? (offset << 32) | read32() :
+                offset | (static_cast<std::uint64_t>(read32()) << 32);
+        }
+        offsets_.emplace_back(offset);
+        ids_.emplace(names_.back(), i);
+    }
+    records_.resize(num_sequences);
 
-        dst.emplace_back(std::unique_ptr<T>(new T(
-            (const char*) &(name[1]), name_length - 1,
-            (const char*) sequence, sequence_length,
-            (const char*) quality, quality_length)));
+    is_index_parsed_ = true;
+}
 
-        ++num_objects;
-        current_bytes = 0;
-        name_length = 0;
-        sequence_length = 0;
-        quality_length = 0;
-        is_valid = false;
-    };
+template<class T>
+inline const typename TwoBitParser<T>::Record& TwoBitParser<T>::parse_record(
+    std::uint32_t id) {
 
-    while (!is_end) {
+    if (records_[id] != nullptr) {
+        return *records_[id];
+    }
 
-        std::uint64_t read_bytes = gzfread(this->buffer_.data(), sizeof(char),
-            this->buffer_.size(), input_file);
-        is_end = gzeof(input_file);
+    if (std::fseek(two_bit_file_.get(), offsets_[id], SEEK_SET) != 0) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
 
-        total_bytes += read_bytes;
-        if (max_bytes != 0 && total_bytes > max_bytes) {
-            if (last_object_id == num_objects) {
-                throw std::invalid_argument("[bioparser::FastqParser] error: "
-                    "too small chunk size!");
-            }
-            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
-            status = true;
-            break;
+    // sizes are stored after all starts and are turned into ends, blocks do
+    // not overlap so ends are sorted as well
+    auto read_blocks = [&] (std::vector<std::uint32_t>& dst) -> void {
+        std::uint32_t num_blocks = read32();
+        dst.resize(2 * num_blocks);
+        for (std::uint32_t i = 0; i < dst.size(); ++i) {
+            dst[i] = read32();
         }
+        for (std::uint32_t i = 0; i < num_blocks; ++i) {
+            dst[num_blocks + i] = std::min<std::uint64_t>(
+                static_cast<std::uint64_t>(dst[i]) + dst[num_blocks + i],
+                static_cast<std::uint32_t>(-1));
+        }
+    };
 
-        for (std::uint32_t i = 0; i < read_bytes; ++i) {
-            auto c = this->buffer_[i];
+    std::unique_ptr<Record> record(new Record());
+    record->length = read32();
+    read_blocks(record->n_blocks);
+    read_blocks(record->mask_blocks);
+    read32();
+    record->packed_offset = std::ftell(two_bit_file_.get());
 
-            if (c == '\n') {
-                if (!(line_number == 1 || (line_number == 3 && quality_length < sequence_length))) {
-                    line_number = (line_number + 1) % 4;
-                    if (line_number == 0) {
-                        is_valid = true;
-                    }
-                }
-            } else if (line_number == 1 && c == '+') {
-                line_number = 2;
-            } else {
-                switch (line_number) {
-                    case 0:
-                        if (name_length < kSSS) {
-                            if (!(name_length == 0 && isspace(c))) {
-                                name[name_length++] = c;
-                            }
-                        }
-                        break;
-                    case 1:
-                        sequence[sequence_length++] = c;
-                        if (sequence_length == kMSS) {
-                            this->storage_.resize(kSSS + 2 * kLSS, 0);
-                            name = &(this->storage_[0]);
-                            sequence = &(this->storage_[kSSS]);
-                            quality = &(this->storage_[kSSS + kLSS]);
-                        }
-                        break;
-                    case 2:
-                        // comment line starting with '+'
-                        // do nothing
-                        break;
-                    case 3:
-                        quality[quality_length++] = c;
-                        break;
-                    default:
-                        // never reaches this case
-                        break;
+    records_[id] = std::move(record);
+    return *records_[id];
+}
+
+// four bases of each packed byte, most significant bits first
+inline const char* twoBitTable() {
+    static const std::string table = [] () -> std::string {
+        const char kBases[] = "TCAG";
+        std::string dst(1024, 0);
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            for (std::uint32_t j = 0; j < 4; ++j) {
+                dst[4 * i + j] = kBases[(i >> (6 - 2 * j)) & 3];
+            }
+        }
+        return dst;
+    }();
+    return table.data();
+}
+
+template<class T>
+inline void TwoBitParser<T>::unpack(const Record& record, std::uint32_t begin,
+    std::uint32_t end, char* dst) {
+
+    if (begin == end) {
+        return;
+    }
+
+    std::uint64_t packed_begin = begin / 4;
+    std::uint64_t packed_length = (end + 3) / 4 - packed_begin;
+    packed_.resize(packed_length);
+    if (std::fseek(two_bit_file_.get(), record.packed_offset + packed_begin,
+            SEEK_SET) != 0 ||
+        std::fread(packed_.data(), 1, packed_length, two_bit_file_.get()) !=
+            packed_length) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
+
+    // table lookup writes four bases per packed byte
+    auto table = twoBitTable();
+    const std::uint8_t* src = packed_.data();
+    std::uint32_t length = end - begin, i = 0, shift = begin % 4;
+    if (shift != 0) {
+        i = std::min(4 - shift, length);
+        std::memcpy(dst, &table[4 * *src++ + shift], i);
+    }
+    for (; i + 4 <= length; i += 4) {
+        std::memcpy(&dst[i], &table[4 * *src++], 4);
+    }
+    if (i < length) {
+        std::memcpy(&dst[i], &table[4 * *src], length - i);
+    }
+
+    auto apply_blocks = [&] (const std::vector<std::uint32_t>& blocks,
+        bool is_mask) -> void {
+
+        // the first block ending after begin is found with a binary search
+        std::uint32_t num_blocks = blocks.size() / 2;
+        auto ends = blocks.begin() + num_blocks;
+        std::uint32_t j = std::upper_bound(ends, blocks.end(), begin) - ends;
+        for (; j < num_blocks && blocks[j] < end; ++j) {
+            std::uint32_t block_begin = std::max(blocks[j], begin);
+            std::uint32_t block_end = std::min(blocks[num_blocks + j], end);
+            if (block_begin >= block_end) {
+                continue;
+            }
+            if (is_mask) {
+                for (auto k = block_begin; k < block_end; ++k) {
+                    dst[k - begin] |= 0x20;
                 }
+            } else {
+                std::memset(&dst[block_begin - begin], 'N',
+                    block_end - block_begin);
             }
+        }
+    };
 
-            ++current_bytes;
+    apply_blocks(record.n_blocks, false);
+    apply_blocks(record.mask_blocks, true);
+}
 
-            if (is_valid) {
-                create_T();
+template<class T>
+inline const std::vector<std::string>& TwoBitParser<T>::sequence_names() {
+    parse_index();
+    return names_;
+}
+
+template<class T>
+inline std::uint32_t TwoBitParser<T>::sequence_length(
+    const std::string& name) {
+
+    parse_index();
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "unknown sequence " + name + "!");
+    }
+    return parse_record(it->second).length;
+}
+
+template<class T>
+inline std::string TwoBitParser<T>::fetch(const std::string& name,
+    std::uint32_t begin, std::uint32_t end) {
+
+    parse_index();
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "unknown sequence " + name + "!");
+    }
+    const auto& record = parse_record(it->second);
+    if (begin > end || end > record.length) {
+        throw std::invalid_argument("[bioparser::TwoBitParser] error: "
+            "invalid range of sequence " + name + "!");
+    }
+
+    std::string dst(end - begin, 0);
+    unpack(record, begin, end, &dst[0]);
+    return dst;
+}
+
+template<class T>
+inline bool TwoBitParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool) {
+
+    parse_index();
+
+    std::uint64_t total_bytes = 0;
+    std::uint32_t num_objects = 0;
+    this->open_batch();
+
+    for (; sequence_id_ < names_.size(); ++sequence_id_) {
+        const auto& name = names_[sequence_id_];
+        const auto& record = parse_record(sequence_id_);
+        auto length = record.length;
+
+        total_bytes += name.size() + length;
+        if (max_bytes != 0 && total_bytes > max_bytes) {
+            if (num_objects == 0) {
+                throw ChunkSizeError("[bioparser::TwoBitParser] error: "
+                    "too small chunk size!");
             }
+            return true;
         }
 
-        if (is_end && current_bytes != 0) {
-            create_T();
+        if (this->storage_.size() < length) {
+            this->storage_.resize(length);
+        }
+        unpack(record, 0, length, this->storage_.data());
+
+        dst.emplace_back(std::unique_ptr<T>(new T(
+            (const char*) name.c_str(), name.size(),
+            (const char*) this->storage_.data(), length)));
+        ++num_objects;
+
+        this->count(length, *dst.back(), name.size() + length);
+        if (this->is_batch_full()) {
+            ++sequence_id_;
+            return sequence_id_ < names_.size();
         }
     }
 
-    return status;
+    return false;
 }
 
 template<class T>
-inline MhapParser<T>::MhapParser(gzFile input_file)
-        : Parser<T>(input_file, kSSS) {
+inline BedParser<T>::BedParser(gzFile input_file)
+        : Parser<T>(input_file, 3 * kSSS) {
 }
 
 template<class T>
-inline MhapParser<T>::~MhapParser() {
+inline BedParser<T>::~BedParser() {
 }
 
 template<class T>
-inline bool MhapParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+inline void BedParser<T>::createT(std::vector<std::unique_ptr<T>>& dst,
+    const char* chromosome, std::uint32_t chromosome_length,
+    std::uint32_t begin, std::uint32_t end, const char* name,
+    std::uint32_t name_length, std::uint32_t score, char strand,
+    std::true_type) {
+
+    dst.emplace_back(std::unique_ptr<T>(new T(chromosome, chromosome_length,
+        begin, end, name, name_length, score, strand)));
+}
+
+template<class T>
+inline void BedParser<T>::createT(std::vector<std::unique_ptr<T>>&,
+    const char*, std::uint32_t, std::uint32_t, std::uint32_t, const char*,
+    std::uint32_t, std::uint32_t, char, std::false_type) {
+
+    throw std::invalid_argument("[bioparser::BedParser] error: "
+        "missing constructor, parse into BedIntervals instead!");
+}
+
+template<class T>
+inline bool BedParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
     std::uint64_t max_bytes, bool) {
 
+    this->open_batch();
+    return parse_lines(max_bytes, [&] (const char* chromosome,
+        std::uint32_t chromosome_length, std::uint32_t begin,
+        std::uint32_t end, const char* name, std::uint32_t name_length,
+        std::uint32_t score, char strand) -> void {
+
+        createT(dst, chromosome, chromosome_length, begin, end, name,
+            name_length, score, strand,
+            std::integral_constant<bool, is_supported()>());
+        this->count(end - begin, *dst.back(), chromosome_length +
+            name_length);
+    });
+}
+
+template<class T>
+inline bool BedParser<T>::parse(BedIntervals& dst, std::uint64_t max_bytes) {
+
+    this->open_batch();
+    auto status = parse_lines(max_bytes, [&] (const char* chromosome,
+        std::uint32_t chromosome_length, std::uint32_t begin,
+        std::uint32_t end, const char*, std::uint32_t, std::uint32_t,
+        char) -> void {
+
+        dst.new_ids_.emplace_back(dst.intern(chromosome, chromosome_length));
+        dst.new_begins_.emplace_back(begin);
+        dst.new_ends_.emplace_back(end);
+        this->count(end - begin);
+    });
+    dst.sort();
+    return status;
+}
+
+template<class T>
+template<class F>
+inline bool BedParser<T>::parse_lines(std::uint64_t max_bytes, F create) {
+
     auto input_file = this->input_file_.get();
-    bool is_end = gzeof(input_file);
+    bool is_end = this->is_eof();
     bool status = false;
     std::uint64_t current_bytes = 0;
     std::uint64_t total_bytes = 0;
     std::uint64_t num_objects = 0;
     std::uint64_t last_object_id = num_objects;
 
-    const std::uint32_t kMhapObjectLength = 12;
+    const std::uint32_t kBedObjectLength = 6;
 
     char* line = &(this->storage_[0]);
     std::uint32_t line_length = 0;
 
-    std::uint64_t a_id = 0, b_id = 0;
-    std::uint32_t a_rc = 0, a_begin = 0, a_end = 0, a_length = 0, b_rc = 0,
-        b_begin = 0, b_end = 0, b_length = 0, minmers = 0;
-    double error = 0;
-
     auto create_T = [&] () -> void {
-        line[line_length] = 0;
         rightStrip(line, line_length);
 
-        std::uint32_t num_values = 0, begin = 0;
-        while (true) {
-            std::uint32_t end = begin;
-            for (std::uint32_t j = begin; j < line_length; ++j) {
-                if (line[j] == ' ') {
-                    end = j;
-                    break;
-                }
-            }
-            if (end == begin) {
-                end = line_length;
-            }
-            line[end] = 0;
+        // empty, comment and track lines
+        if (line_length == 0 || line[0] == '#' ||
+            (line_length >= 5 && std::strncmp(line, "track", 5) == 0) ||
+            (line_length >= 7 && std::strncmp(line, "browser", 7) == 0)) {
+            current_bytes = 0;
+            line_length = 0;
+            return;
+        }
 
-            switch (num_values) {
-                case 0: a_id = atoll(&line[begin]); break;
-                case 1: b_id = atoll(&line[begin]); break;
-                case 2: error = atof(&line[begin]); break;
-                case 3: minmers = atoi(&line[begin]); break;
-                case 4: a_rc = atoi(&line[begin]); break;
-                case 5: a_begin = atoi(&line[begin]); break;
-                case 6: a_end = atoi(&line[begin]); break;
-                case 7: a_length = atoi(&line[begin]); break;
-                case 8: b_rc = atoi(&line[begin]); break;
-                case 9: b_begin = atoi(&line[begin]); break;
-                case 10: b_end = atoi(&line[begin]); break;
-                case 11: b_length = atoi(&line[begin]); break;
-                default: break;
-            }
-            num_values++;
-            if (end == line_length || num_values == kMhapObjectLength) {
+        const char* values[kBedObjectLength] = {};
+        std::uint32_t lengths[kBedObjectLength] = {};
+        std::uint32_t num_values = 0;
+
+        for (std::uint32_t begin = 0; num_values < kBedObjectLength;) {
+            auto end = static_cast<const char*>(std::memchr(&line[begin],
+                '\t', line_length - begin));
+            values[num_values] = &line[begin];
+            lengths[num_values] = (end == nullptr ? line_length :
+                end - line) - begin;
+            ++num_values;
+            if (end == nullptr) {
                 break;
             }
-            begin = end + 1;
+            begin = end - line + 1;
         }
 
-        if (num_values != kMhapObjectLength) {
-            throw std::invalid_argument("[bioparser::MhapParser] error: "
+        std::uint32_t begin = 0, end = 0, score = 0;
+        if (num_values < 3 || lengths[0] == 0 ||
+            !parseUint32(values[1], lengths[1], begin) ||
+            !parseUint32(values[2], lengths[2], end) || begin > end) {
+            throw std::invalid_argument("[bioparser::BedParser] error: "
                 "invalid file format!");
         }
+        // scores that are not unsigned integers (e.g. "5.3") are set to 0
+        if (num_values > 4) {
+            parseUint32(values[4], lengths[4], score);
+        }
 
-        dst.emplace_back(std::unique_ptr<T>(new T(a_id, b_id, error,
-            minmers, a_rc, a_begin, a_end, a_length, b_rc, b_begin,
-            b_end, b_length)));
+        create(values[0], std::min(lengths[0], kSSS), begin, end,
+            values[3], std::min(lengths[3], kSSS), score,
+            num_values > 5 && lengths[5] > 0 ? values[5][0] : '.');
 
         ++num_objects;
         current_bytes = 0;
@@ -579,14 +6074,13 @@ inline bool MhapParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
 
     while (!is_end) {
 
-        std::uint64_t read_bytes = gzfread(this->buffer_.data(), sizeof(char),
-            this->buffer_.size(), input_file);
+        std::uint64_t read_bytes = this->read_block();
         is_end = gzeof(input_file);
 
         total_bytes += read_bytes;
         if (max_bytes != 0 && total_bytes > max_bytes) {
             if (last_object_id == num_objects) {
-                throw std::invalid_argument("[bioparser::MhapParser] error: "
+                throw ChunkSizeError("[bioparser::BedParser] error: "
                     "too small chunk size!");
             }
             gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
@@ -594,18 +6088,36 @@ inline bool MhapParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
             break;
         }
 
-        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+        const char* buffer = this->buffer_.data();
+        for (std::uint32_t i = 0; i < read_bytes;) {
 
-            auto c = this->buffer_[i];
-            ++current_bytes;
+            // lines are copied at once
+            auto it = static_cast<const char*>(std::memchr(&buffer[i], '\n',
+                read_bytes - i));
+            std::uint32_t j = it == nullptr ? read_bytes : it - buffer;
 
-            if (c == '\n') {
+            if (line_length + (j - i) > this->storage_.size()) {
+                this->storage_.resize(2 * (line_length + (j - i)));
+                line = &(this->storage_[0]);
+            }
+            std::memcpy(&line[line_length], &buffer[i], j - i);
+            line_length += j - i;
+            current_bytes += j - i;
+
+            if (j < read_bytes) {
+                ++current_bytes;
                 create_T();
-            } else {
-                line[line_length++] = c;
+                if (this->is_batch_full()) {
+                    status = this->keep_block(j + 1, read_bytes);
+                    break;
+                }
             }
+            i = j + 1;
         }
 
+        if (this->is_batch_full()) {
+            break;
+        }
         if (is_end && current_bytes != 0) {
             create_T();
         }
@@ -614,365 +6126,923 @@ inline bool MhapParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
     return status;
 }
 
+template<template<class> class P, class T>
+inline std::unique_ptr<MultiParser<P, T>> createParser(
+    const std::vector<std::string>& paths) {
+
+    return std::unique_ptr<MultiParser<P, T>>(new MultiParser<P, T>(paths));
+}
+
+// braced lists of paths would be ambiguous between std::string and
+// std::vector<std::string>
+template<template<class> class P, class T>
+inline std::unique_ptr<MultiParser<P, T>> createParser(
+    std::initializer_list<std::string> paths) {
+    return createParser<P, T>(std::vector<std::string>(paths));
+}
+
+template<template<class> class P, class T>
+inline MultiParser<P, T>::MultiParser(const std::vector<std::string>& paths)
+        : Parser<T>(nullptr, 0), paths_(paths), next_path_id_(0), parser_(),
+        next_parser_() {
+    open_next();
+}
+
+template<template<class> class P, class T>
+inline MultiParser<P, T>::~MultiParser() {
+}
+
+template<template<class> class P, class T>
+inline void MultiParser<P, T>::open_next() {
+
+    if (next_parser_.valid()) {
+        parser_ = next_parser_.get();
+    } else if (next_path_id_ < paths_.size()) {
+        parser_ = createParser<P, T>(paths_[next_path_id_++]);
+    } else {
+        parser_ = nullptr;
+    }
+
+    // the first block is kept as if a previous batch had stopped before it
+    if (parser_ != nullptr && next_path_id_ < paths_.size()) {
+        next_parser_ = std::async(std::launch::async,
+            [] (const std::string& path) -> std::unique_ptr<P<T>> {
+                auto dst = createParser<P, T>(path);
+                auto parser = static_cast<Parser<T>*>(dst.get());
+                if (parser->input_file_ != nullptr) {
+                    parser->keep_block(0, parser->read_block());
+                }
+                return dst;
+            }, paths_[next_path_id_++]);
+    }
+}
+
+template<template<class> class P, class T>
+inline std::uint64_t MultiParser<P, T>::position() const {
+    auto parser = static_cast<const Parser<T>*>(parser_.get());
+    return parser->input_file_ == nullptr ? 0 : parser->tell();
+}
+
+template<template<class> class P, class T>
+inline bool MultiParser<P, T>::is_binary() const {
+    return static_cast<const Parser<T>*>(parser_.get())->input_file_ ==
+        nullptr;
+}
+
+template<template<class> class P, class T>
+inline void MultiParser<P, T>::reset() {
+    if (next_parser_.valid()) {
+        next_parser_.wait();
+        next_parser_ = std::future<std::unique_ptr<P<T>>>();
+    }
+    parser_ = nullptr;
+    next_path_id_ = 0;
+    open_next();
+}
+
+template<template<class> class P, class T>
+inline bool MultiParser<P, T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes, bool trim) {
+
+    std::uint64_t total_bytes = 0;
+    auto num_objects = dst.size();
+    this->open_batch();
+
+    while (parser_ != nullptr) {
+        auto begin = position();
+        auto last_object_id = dst.size();
+
+        // the rest of the limits applies to the current file
+        auto parser = static_cast<Parser<T>*>(parser_.get());
+        parser->limits_ = this->limits_;
+        if (this->limits_.max_records != 0) {
+            parser->limits_.max_records -= this->num_records_;
+        }
+        if (this->limits_.max_bases != 0) {
+            parser->limits_.max_bases -= this->num_bases_;
+        }
+        if (this->limits_.max_memory != 0) {
+            parser->limits_.max_memory -= this->memory_size_;
+        }
+
+        bool status = false;
+        try {
+            status = parser_->parse(dst, max_bytes == 0 ? 0 :
+                max_bytes - total_bytes, trim);
+        } catch (const ChunkSizeError&) {
+            // the first record of a file does not fit into the rest of the
+            // batch, it is parsed again by the next call
+            if (last_object_id == num_objects || dst.size() != last_object_id) {
+                throw;
+            }
+            parser_->reset();
+            return true;
+        }
+        this->num_records_ += parser->num_records_;
+        this->num_bases_ += parser->num_bases_;
+        this->memory_size_ += parser->memory_size_;
+        if (status) {
+            return true;
+        }
+
+        // bytes of binary formats are not tracked, their batches end with
+        // each file so that max_bytes still bounds them
+        bool is_last = is_binary();
+        total_bytes += position() - begin;
+        open_next();
+
+        if (is_last || (max_bytes != 0 && total_bytes >= max_bytes) ||
+            this->is_batch_full()) {
+            return parser_ != nullptr;
+        }
+    }
+
+    return false;
+}
+
+template<template<class> class P, class T, class O>
+inline StaticParser<P, T, O>::StaticParser(const std::string& path)
+        : parser_(createParser<P, T>(path)) {
+}
+
+template<template<class> class P, class T, class O>
+inline void StaticParser<P, T, O>::reset() {
+    parser_->P<T>::reset();
+}
+
+template<template<class> class P, class T, class O>
+inline bool StaticParser<P, T, O>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t max_bytes) {
+    return parse(decltype(hasOptions<P<T>>(0))(), dst, max_bytes);
+}
+
+// qualified calls are not dispatched through the vtable
+template<template<class> class P, class T, class O>
+inline bool StaticParser<P, T, O>::parse(std::true_type,
+    std::vector<std::unique_ptr<T>>& dst, std::uint64_t max_bytes) {
+    return parser_->P<T>::template parse<O>(dst, max_bytes);
+}
+
+template<template<class> class P, class T, class O>
+inline bool StaticParser<P, T, O>::parse(std::false_type,
+    std::vector<std::unique_ptr<T>>& dst, std::uint64_t max_bytes) {
+    return parser_->P<T>::parse(dst, max_bytes, O::kTrim == Trim::kHard);
+}
+
+template<template<class> class P, class T, class O>
+inline P<T>* StaticParser<P, T, O>::operator->() {
+    return parser_.get();
+}
+
+template<template<class> class P, class T, class O>
+inline const P<T>* StaticParser<P, T, O>::operator->() const {
+    return parser_.get();
+}
+
 template<class T>
-inline PafParser<T>::PafParser(gzFile input_file)
-        : Parser<T>(input_file, 3 * kSSS + kMSS) {
+inline HLFastqParser<T>::HLFastqParser(gzFile input_file)
+        : Parser<T>(input_file, kSSS + 2 * kMSS),
+        seq_(kseq_init(input_file), kseq_destroy) {
 }
 
 template<class T>
-inline PafParser<T>::~PafParser() {
+inline HLFastqParser<T>::~HLFastqParser() {
 }
 
 template<class T>
-inline bool PafParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
-    std::uint64_t max_bytes, bool trim) {
+inline void HLFastqParser<T>::reset() {
+    Parser<T>::reset();
+    kseq_rewind(seq_.get());
+}
 
-    auto input_file = this->input_file_.get();
-    bool is_end = gzeof(input_file);
-    bool status = false;
-    std::uint64_t current_bytes = 0;
-    std::uint64_t total_bytes = 0;
-    std::uint64_t num_objects = 0;
-    std::uint64_t last_object_id = num_objects;
+template<class T>
+inline bool HLFastqParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
+    std::uint64_t, bool) {
 
-    const std::uint32_t kPafObjectLength = 12;
+    auto seq = seq_.get();
+    this->open_batch();
 
-    char* line = &(this->storage_[0]);
-    std::uint32_t line_length = 0;
+    while (kseq_read(seq) >= 0){
+        dst.emplace_back(std::unique_ptr<T>(new T(
+            (const char*) seq->name.s, seq->name.l,
+            (const char*) seq->seq.s, seq->seq.l,
+            (const char*) seq->qual.s, seq->qual.l))
+        );
+        this->count(seq->seq.l, *dst.back(),
+            seq->name.l + seq->seq.l + seq->qual.l);
+        if (this->is_batch_full()) {
+            return true;
+        }
+    }
+    return false; // break the user's parser loop
+}
 
-    const char* q_name = nullptr, * t_name = nullptr;
+template<class W>
+inline std::unique_ptr<W> createWriter(const std::string& path) {
 
-    std::uint32_t q_name_length = 0, q_length = 0, q_begin = 0, q_end = 0,
-        t_name_length = 0, t_length = 0, t_begin = 0, t_end = 0,
-        matching_bases = 0, overlap_length = 0, mapping_quality = 0;
-    char orientation = '\0';
+    auto output_file = std::fopen(path.c_str(), "wb");
+    if (output_file == nullptr) {
+        throw std::invalid_argument("[bioparser::createWriter] error: "
+            "unable to open file " + path + "!");
+    }
 
-    auto create_T = [&] () -> void {
-        line[line_length] = 0;
-        rightStrip(line, line_length);
+    bool is_compressed = path.size() > 3 &&
+        path.compare(path.size() - 3, 3, ".gz") == 0;
+    return std::unique_ptr<W>(new W(output_file, is_compressed));
+}
 
-        std::uint32_t num_values = 0, begin = 0;
-        while (true) {
-            std::uint32_t end = begin;
-            for (std::uint32_t j = begin; j < line_length; ++j) {
-                if (line[j] == '\t') {
-                    end = j;
-                    break;
-                }
-            }
-            if (end == begin) {
-                end = line_length;
-            }
-            line[end] = 0;
+// writes the decimal digits of value to dst and returns their number
+inline std::uint32_t formatUnsigned(std::uint64_t value, char* dst) {
+
+    static const char kDigits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "68697071727374757677787980818283848586878889909192939495969798"
+        "99";
+
+    char digits[20];
+    std::uint32_t i = 20;
+    while (value >= 100) {
+        auto pair = (value % 100) * 2;
+        value /= 100;
+        digits[--i] = kDigits[pair + 1];
+        digits[--i] = kDigits[pair];
+    }
+    if (value >= 10) {
+        digits[--i] = kDigits[value * 2 + 1];
+        digits[--i] = kDigits[value * 2];
+    } else {
+        digits[--i] = '0' + value;
+    }
+
+    std::memcpy(dst, &digits[i], 20 - i);
+    return 20 - i;
+}
+
+inline Writer::Writer(std::FILE* output_file, bool is_compressed)
+        : output_file_(output_file, std::fclose), is_compressed_(is_compressed),
+        num_threads_(std::max(std::thread::hardware_concurrency(), 1U)),
+        buffer_(kWriterBlockSize, 0), buffer_length_(0) {
+}
+
+inline Writer::~Writer() {
+    try {
+        flush();
+    } catch (std::exception&) {
+        // destructors do not throw, call flush() to catch write errors
+    }
+}
+
+inline void Writer::set_num_threads(std::uint32_t num_threads) {
+    num_threads_ = std::max(num_threads, 1U);
+}
+
+inline void Writer::append(const char* src, std::uint32_t src_length) {
+    if (buffer_length_ + src_length > buffer_.size()) {
+        buffer_.resize(2 * (buffer_length_ + src_length));
+    }
+    std::memcpy(&buffer_[buffer_length_], src, src_length);
+    buffer_length_ += src_length;
+}
+
+inline void Writer::append(char c) {
+    if (buffer_length_ == buffer_.size()) {
+        buffer_.resize(2 * buffer_.size());
+    }
+    buffer_[buffer_length_++] = c;
+}
+
+inline void Writer::append_unsigned(std::uint64_t value) {
+    if (buffer_length_ + 20 > buffer_.size()) {
+        buffer_.resize(2 * (buffer_length_ + 20));
+    }
+    buffer_length_ += formatUnsigned(value, &buffer_[buffer_length_]);
+}
+
+inline void Writer::append_signed(std::int64_t value) {
+    if (value < 0) {
+        append('-');
+        append_unsigned(-static_cast<std::uint64_t>(value));
+    } else {
+        append_unsigned(value);
+    }
+}
+
+inline void Writer::end_record() {
+    append('\n');
+    // compressed output is batched into one block per thread
+    if (buffer_length_ >= (is_compressed_ ? num_threads_ : 1) *
+        static_cast<std::uint64_t>(kWriterBlockSize)) {
+        flush();
+    }
+}
+
+inline void Writer::flush() {
+
+    if (buffer_length_ == 0) {
+        return;
+    }
+
+    if (!is_compressed_) {
+        if (std::fwrite(buffer_.data(), 1, buffer_length_,
+                output_file_.get()) != buffer_length_ ||
+            std::fflush(output_file_.get()) != 0) {
+            throw std::invalid_argument("[bioparser::Writer] error: "
+                "unable to write to file!");
+        }
+        buffer_length_ = 0;
+        return;
+    }
 
-            switch (num_values) {
-                case 0:
-                    q_name = &line[begin];
-                    q_name_length = end - begin;
-                    break;
-                case 1: q_length = atoi(&line[begin]); break;
-                case 2: q_begin = atoi(&line[begin]); break;
-                case 3: q_end = atoi(&line[begin]); break;
-                case 4: orientation = line[begin]; break;
-                case 5:
-                    t_name = &line[begin];
-                    t_name_length = end - begin;
-                    break;
-                case 6: t_length = atoi(&line[begin]); break;
-                case 7: t_begin = atoi(&line[begin]); break;
-                case 8: t_end = atoi(&line[begin]); break;
-                case 9: matching_bases = atoi(&line[begin]); break;
-                case 10: overlap_length = atoi(&line[begin]); break;
-                case 11: mapping_quality = atoi(&line[begin]); break;
-                default: break;
-            }
-            num_values++;
-            if (end == line_length || num_values == kPafObjectLength) {
-                break;
+    // each block is deflated into an independent gzip member, concatenated
+    // members form a valid gzip file
+    std::uint32_t num_blocks = (buffer_length_ + kWriterBlockSize - 1) /
+        kWriterBlockSize;
+    std::vector<std::vector<char>> blocks(num_blocks);
+
+    std::atomic<std::uint32_t> next_block(0);
+    std::atomic<bool> is_valid(true);
+
+    auto deflate_block = [&] () -> void {
+        for (std::uint32_t i = next_block++; i < num_blocks; i = next_block++) {
+            std::uint64_t begin = static_cast<std::uint64_t>(i) *
+                kWriterBlockSize;
+            std::uint32_t length = std::min<std::uint64_t>(kWriterBlockSize,
+                buffer_length_ - begin);
+
+            z_stream stream;
+            stream.zalloc = Z_NULL;
+            stream.zfree = Z_NULL;
+            stream.opaque = Z_NULL;
+            if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                    15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                is_valid = false;
+                continue;
             }
-            begin = end + 1;
-        }
 
-        if (num_values != kPafObjectLength) {
-            throw std::invalid_argument("[bioparser::PafParser] error: "
-                "invalid file format!");
+            auto& block = blocks[i];
+            block.resize(deflateBound(&stream, length));
+            stream.next_in = reinterpret_cast<Bytef*>(&buffer_[begin]);
+            stream.avail_in = length;
+            stream.next_out = reinterpret_cast<Bytef*>(block.data());
+            stream.avail_out = block.size();
+
+            if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+                is_valid = false;
+            }
+            block.resize(stream.total_out);
+            deflateEnd(&stream);
         }
+    };
 
-        q_name_length = std::min(q_name_length, kSSS);
-        t_name_length = std::min(t_name_length, kSSS);
+    std::vector<std::thread> threads;
+    for (std::uint32_t i = 1; i < std::min(num_threads_, num_blocks); ++i) {
+        threads.emplace_back(deflate_block);
+    }
+    deflate_block();
+    for (auto& it: threads) {
+        it.join();
+    }
 
-        if (trim) {
-            rightStripHard(q_name, q_name_length);
-            rightStripHard(t_name, t_name_length);
-        } else {
-            rightStrip(q_name, q_name_length);
-            rightStrip(t_name, t_name_length);
-        }
+    if (!is_valid) {
+        throw std::invalid_argument("[bioparser::Writer] error: "
+            "unable to compress output!");
+    }
 
-        if (q_name_length == 0 || t_name_length == 0) {
-            throw std::invalid_argument("[bioparser::PafParser] error: "
-                "invalid file format!");
+    for (const auto& it: blocks) {
+        if (std::fwrite(it.data(), 1, it.size(), output_file_.get()) !=
+            it.size()) {
+            throw std::invalid_argument("[bioparser::Writer] error: "
+                "unable to write to file!");
         }
+    }
+    if (std::fflush(output_file_.get()) != 0) {
+        throw std::invalid_argument("[bioparser::Writer] error: "
+            "unable to write to file!");
+    }
+    buffer_length_ = 0;
+}
 
-        dst.emplace_back(std::unique_ptr<T>(new T(q_name, q_name_length,
-            q_length, q_begin, q_end, orientation, t_name, t_name_length,
-            t_length, t_begin, t_end, matching_bases, overlap_length,
-            mapping_quality)));
+inline PafWriter::PafWriter(std::FILE* output_file, bool is_compressed)
+        : Writer(output_file, is_compressed) {
+}
 
-        ++num_objects;
-        current_bytes = 0;
-        line_length = 0;
-    };
+inline PafWriter::~PafWriter() {
+}
 
-    while (!is_end) {
+inline void PafWriter::write(const char* q_name, std::uint32_t q_name_length,
+    std::uint32_t q_length, std::uint32_t q_begin, std::uint32_t q_end,
+    char orientation, const char* t_name, std::uint32_t t_name_length,
+    std::uint32_t t_length, std::uint32_t t_begin, std::uint32_t t_end,
+    std::uint32_t matching_bases, std::uint32_t overlap_length,
+    std::uint32_t mapping_quality, const char* tags,
+    std::uint32_t tags_length) {
+
+    append(q_name, q_name_length);
+    append('\t');
+    append_unsigned(q_length);
+    append('\t');
+    append_unsigned(q_begin);
+    append('\t');
+    append_unsigned(q_end);
+    append('\t');
+    append(orientation);
+    append('\t');
+    append(t_name, t_name_length);
+    append('\t');
+    append_unsigned(t_length);
+    append('\t');
+    append_unsigned(t_begin);
+    append('\t');
+    append_unsigned(t_end);
+    append('\t');
+    append_unsigned(matching_bases);
+    append('\t');
+    append_unsigned(overlap_length);
+    append('\t');
+    append_unsigned(mapping_quality);
+    if (tags_length != 0) {
+        append('\t');
+        append(tags, tags_length);
+    }
+    end_record();
+}
 
-        std::uint64_t read_bytes = gzfread(this->buffer_.data(), sizeof(char),
-            this->buffer_.size(), input_file);
-        is_end = gzeof(input_file);
+inline SamWriter::SamWriter(std::FILE* output_file, bool is_compressed)
+        : Writer(output_file, is_compressed) {
+}
 
-        total_bytes += read_bytes;
-        if (max_bytes != 0 && total_bytes > max_bytes) {
-            if (last_object_id == num_objects) {
-                throw std::invalid_argument("[bioparser::PafParser] error: "
-                    "too small chunk size!");
-            }
-            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
-            status = true;
-            break;
-        }
+inline SamWriter::~SamWriter() {
+}
 
-        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+inline void SamWriter::append_field(const char* src,
+    std::uint32_t src_length) {
 
-            auto c = this->buffer_[i];
-            ++current_bytes;
+    if (src_length == 0) {
+        append('*');
+    } else {
+        append(src, src_length);
+    }
+}
 
-            if (c == '\n') {
-                create_T();
-            } else {
-                line[line_length++] = c;
-                if (line_length == this->storage_.size()) {
-                    this->storage_.resize(3 * kSSS + kLSS);
-                    line = &(this->storage_[0]);
-                }
-            }
-        }
+inline void SamWriter::write_header(const char* header,
+    std::uint32_t header_length) {
 
-        if (is_end && current_bytes != 0) {
-            create_T();
-        }
+    append(header, header_length);
+    if (header_length != 0 && header[header_length - 1] != '\n') {
+        append('\n');
     }
+}
 
-    return status;
+inline void SamWriter::write(const char* q_name, std::uint32_t q_name_length,
+    std::uint32_t flag, const char* t_name, std::uint32_t t_name_length,
+    std::uint32_t t_begin, std::uint32_t mapping_quality,
+    const char* cigar, std::uint32_t cigar_length,
+    const char* t_next_name, std::uint32_t t_next_name_length,
+    std::uint32_t t_next_begin, std::uint32_t template_length,
+    const char* sequence, std::uint32_t sequence_length,
+    const char* quality, std::uint32_t quality_length) {
+
+    append_field(q_name, q_name_length);
+    append('\t');
+    append_unsigned(flag);
+    append('\t');
+    append_field(t_name, t_name_length);
+    append('\t');
+    append_unsigned(t_begin);
+    append('\t');
+    append_unsigned(mapping_quality);
+    append('\t');
+    append_field(cigar, cigar_length);
+    append('\t');
+    append_field(t_next_name, t_next_name_length);
+    append('\t');
+    append_unsigned(t_next_begin);
+    append('\t');
+    // parsers pass negative template lengths in two's complement
+    append_signed(static_cast<std::int32_t>(template_length));
+    append('\t');
+    append_field(sequence, sequence_length);
+    append('\t');
+    append_field(quality, quality_length);
+    end_record();
 }
 
-template<class T>
-inline SamParser<T>::SamParser(gzFile input_file)
-        : Parser<T>(input_file, 5 * kSSS + 2 * kMSS) {
+inline MhapWriter::MhapWriter(std::FILE* output_file, bool is_compressed)
+        : Writer(output_file, is_compressed) {
 }
 
-template<class T>
-inline SamParser<T>::~SamParser() {
+inline MhapWriter::~MhapWriter() {
 }
 
-template<class T>
-inline bool SamParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
-    std::uint64_t max_bytes, bool trim) {
+inline void MhapWriter::write(std::uint64_t a_id, std::uint64_t b_id,
+    double error, std::uint32_t minmers, std::uint32_t a_rc,
+    std::uint32_t a_begin, std::uint32_t a_end, std::uint32_t a_length,
+    std::uint32_t b_rc, std::uint32_t b_begin, std::uint32_t b_end,
+    std::uint32_t b_length) {
+
+    append_unsigned(a_id);
+    append(' ');
+    append_unsigned(b_id);
+    append(' ');
+    // shortest of 15 to 17 significant digits that reads back exactly
+    char error_text[32];
+    int error_length = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        error_length = std::snprintf(error_text, sizeof(error_text), "%.*g",
+            precision, error);
+        if (std::strtod(error_text, nullptr) == error) {
+            break;
+        }
+    }
+    append(error_text, error_length);
+    append(' ');
+    append_unsigned(minmers);
+    append(' ');
+    append_unsigned(a_rc);
+    append(' ');
+    append_unsigned(a_begin);
+    append(' ');
+    append_unsigned(a_end);
+    append(' ');
+    append_unsigned(a_length);
+    append(' ');
+    append_unsigned(b_rc);
+    append(' ');
+    append_unsigned(b_begin);
+    append(' ');
+    append_unsigned(b_end);
+    append(' ');
+    append_unsigned(b_length);
+    end_record();
+}
 
-    auto input_file = this->input_file_.get();
-    bool is_end = gzeof(input_file);
-    bool status = false;
-    std::uint64_t current_bytes = 0;
-    std::uint64_t total_bytes = 0;
-    std::uint64_t num_objects = 0;
-    std::uint64_t last_object_id = num_objects;
+inline SortOptions::SortOptions()
+        : by_target(false), max_bytes(1ULL << 30),
+        num_threads(std::max(std::thread::hardware_concurrency(), 1U)),
+        directory() {
+}
 
-    const std::uint32_t kSamObjectLength = 11;
+// overlap as passed by MhapParser, kept for sorting
+class MhapRecord {
+public:
+    MhapRecord(std::uint64_t a_id, std::uint64_t b_id, double error,
+        std::uint32_t minmers, std::uint32_t a_rc, std::uint32_t a_begin,
+        std::uint32_t a_end, std::uint32_t a_length, std::uint32_t b_rc,
+        std::uint32_t b_begin, std::uint32_t b_end, std::uint32_t b_length)
+            : a_id_(a_id), b_id_(b_id), error_(error), minmers_(minmers),
+            a_rc_(a_rc), a_begin_(a_begin), a_end_(a_end), a_length_(a_length),
+            b_rc_(b_rc), b_begin_(b_begin), b_end_(b_end),
+            b_length_(b_length) {
+    }
 
-    char* line = &(this->storage_[0]);
-    std::uint32_t line_length = 0;
+    bool less(const MhapRecord& other, bool by_target) const {
+        return by_target ?
+            std::tie(b_id_, a_id_, b_begin_, a_begin_) < std::tie(other.b_id_,
+                other.a_id_, other.b_begin_, other.a_begin_) :
+            std::tie(a_id_, b_id_, a_begin_, b_begin_) < std::tie(other.a_id_,
+                other.b_id_, other.a_begin_, other.b_begin_);
+    }
 
-    const char* q_name = nullptr, * t_name = nullptr, * cigar = nullptr,
-        * t_next_name = nullptr, * sequence = nullptr, * quality = nullptr;
+    void write(MhapWriter& writer) const {
+        writer.write(a_id_, b_id_, error_, minmers_, a_rc_, a_begin_, a_end_,
+            a_length_, b_rc_, b_begin_, b_end_, b_length_);
+    }
 
-    std::uint32_t q_name_length = 0, flag = 0, t_name_length = 0, t_begin = 0,
-        mapping_quality = 0, cigar_length = 0, t_next_name_length = 0,
-        t_next_begin = 0, template_length = 0, sequence_length = 0,
-        quality_length = 0;
+private:
+    std::uint64_t a_id_;
+    std::uint64_t b_id_;
+    double error_;
+    std::uint32_t minmers_;
+    std::uint32_t a_rc_;
+    std::uint32_t a_begin_;
+    std::uint32_t a_end_;
+    std::uint32_t a_length_;
+    std::uint32_t b_rc_;
+    std::uint32_t b_begin_;
+    std::uint32_t b_end_;
+    std::uint32_t b_length_;
+};
 
-    auto create_T = [&] () -> void {
+// overlap as passed by PafParser, kept for sorting
+class PafRecord {
+public:
+    PafRecord(const char* q_name, std::uint32_t q_name_length,
+        std::uint32_t q_length, std::uint32_t q_begin, std::uint32_t q_end,
+        char orientation, const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_length, std::uint32_t t_begin, std::uint32_t t_end,
+        std::uint32_t matching_bases, std::uint32_t overlap_length,
+        std::uint32_t mapping_quality, const char* tags,
+        std::uint32_t tags_length)
+            : q_name_(q_name, q_name_length), q_length_(q_length),
+            q_begin_(q_begin), q_end_(q_end), orientation_(orientation),
+            t_name_(t_name, t_name_length), t_length_(t_length),
+            t_begin_(t_begin), t_end_(t_end), matching_bases_(matching_bases),
+            overlap_length_(overlap_length), mapping_quality_(mapping_quality),
+            tags_(tags, tags_length) {
+    }
 
-        line[line_length] = 0;
-        rightStrip(line, line_length);
+    bool less(const PafRecord& other, bool by_target) const {
+        return by_target ?
+            std::tie(t_name_, q_name_, t_begin_, q_begin_) < std::tie(
+                other.t_name_, other.q_name_, other.t_begin_, other.q_begin_) :
+            std::tie(q_name_, t_name_, q_begin_, t_begin_) < std::tie(
+                other.q_name_, other.t_name_, other.q_begin_, other.t_begin_);
+    }
 
-        std::uint32_t num_values = 0, begin = 0;
-        while (true) {
-            std::uint32_t end = begin;
-            for (std::uint32_t j = begin; j < line_length; ++j) {
-                if (line[j] == '\t') {
-                    end = j;
-                    break;
-                }
-            }
-            if (end == begin) {
-                end = line_length;
-            }
-            line[end] = 0;
+    void write(PafWriter& writer) const {
+        writer.write(q_name_.data(), q_name_.size(), q_length_, q_begin_,
+            q_end_, orientation_, t_name_.data(), t_name_.size(), t_length_,
+            t_begin_, t_end_, matching_bases_, overlap_length_,
+            mapping_quality_, tags_.data(), tags_.size());
+    }
 
-            switch (num_values) {
-                case 0:
-                    q_name = &line[begin];
-                    q_name_length = end - begin;
-                    break;
-                case 1: flag = atoi(&line[begin]); break;
-                case 2:
-                    t_name = &line[begin];
-                    t_name_length = end - begin;
-                    break;
-                case 3: t_begin = atoi(&line[begin]); break;
-                case 4: mapping_quality = atoi(&line[begin]); break;
-                case 5:
-                    cigar = &line[begin];
-                    cigar_length = end - begin;
-                    break;
-                case 6:
-                    t_next_name = &line[begin];
-                    t_next_name_length = end - begin;
-                    break;
-                case 7: t_next_begin = atoi(&line[begin]); break;
-                case 8: template_length = atoi(&line[begin]); break;
-                case 9:
-                    sequence = &line[begin];
-                    sequence_length = end - begin;
-                    break;
-                case 10:
-                    quality = &line[begin];
-                    quality_length = end - begin;
-                    break;
-                default: break;
-            }
-            num_values++;
-            if (end == line_length || num_values == kSamObjectLength) {
-                break;
-            }
-            begin = end + 1;
-        }
+private:
+    std::string q_name_;
+    std::uint32_t q_length_;
+    std::uint32_t q_begin_;
+    std::uint32_t q_end_;
+    char orientation_;
+    std::string t_name_;
+    std::uint32_t t_length_;
+    std::uint32_t t_begin_;
+    std::uint32_t t_end_;
+    std::uint32_t matching_bases_;
+    std::uint32_t overlap_length_;
+    std::uint32_t mapping_quality_;
+    std::string tags_;
+};
 
-        if (num_values != kSamObjectLength) {
-            throw std::invalid_argument("[bioparser::SamParser] error: "
-                "invalid file format!");
-        }
+// record and writer types of formats sortOverlaps accepts
+template<template<class> class P>
+struct SortFormat;
 
-        q_name_length = std::min(q_name_length, kSSS);
-        t_name_length = std::min(t_name_length, kSSS);
-        t_next_name_length = std::min(t_next_name_length, kSSS);
+template<>
+struct SortFormat<MhapParser> {
+    using Record = MhapRecord;
+    using Writer = MhapWriter;
+    static constexpr const char* kExtension = ".mhap.gz";
+};
 
-        if (trim) {
-            rightStripHard(q_name, q_name_length);
-            rightStripHard(t_name, t_name_length);
-            rightStripHard(t_next_name, t_next_name_length);
-        } else {
-            rightStrip(q_name, q_name_length);
-            rightStrip(t_name, t_name_length);
-            rightStrip(t_next_name, t_next_name_length);
-        }
+template<>
+struct SortFormat<PafParser> {
+    using Record = PafRecord;
+    using Writer = PafWriter;
+    static constexpr const char* kExtension = ".paf.gz";
+};
 
-        rightStrip(cigar, cigar_length);
-        rightStrip(sequence, sequence_length);
-        rightStrip(quality, quality_length);
+// distinguishes temporary files of concurrent processes
+inline std::uint64_t processId() {
+#if defined(__unix__) || defined(__APPLE__)
+    return getpid();
+#else
+    static const std::uint64_t id =
+        std::chrono::system_clock::now().time_since_epoch().count();
+    return id;
+#endif
+}
 
-        if (q_name_length == 0 || t_name_length == 0 ||
-            cigar_length == 0 || t_next_name_length == 0 ||
-            sequence_length == 0 || quality_length == 0 ||
-            (sequence_length > 1 && quality_length > 1 &&
-            sequence_length != quality_length)) {
+// unique within the process
+inline std::string temporaryPath(const std::string& directory,
+    const char* extension) {
 
-            throw std::invalid_argument("[bioparser::SamParser] error: "
-                "invalid file format!");
+    static std::atomic<std::uint32_t> num_paths(0);
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/') {
+        path += '/';
+    }
+    return path + "bioparser_sort_" + std::to_string(processId()) + "_" +
+        std::to_string(num_paths++) + extension;
+}
+
+template<template<class> class P>
+inline void sortOverlaps(const std::string& input_path,
+    const std::string& output_path, const SortOptions& options) {
+
+    using Record = typename SortFormat<P>::Record;
+    using W = typename SortFormat<P>::Writer;
+    using Records = std::vector<std::unique_ptr<Record>>;
+
+    std::uint32_t num_threads = std::max(options.num_threads, 1U);
+    bool by_target = options.by_target;
+
+    auto less = [by_target] (const std::unique_ptr<Record>& lhs,
+        const std::unique_ptr<Record>& rhs) -> bool {
+        return lhs->less(*rhs, by_target);
+    };
+
+    // slices are sorted on separate threads and merged pairwise
+    auto sort = [&] (Records& records) -> void {
+        std::uint64_t slice_size = std::max<std::uint64_t>(1,
+            (records.size() + num_threads - 1) / num_threads);
+        std::vector<std::uint64_t> bounds;
+        for (std::uint64_t i = 0; i < records.size(); i += slice_size) {
+            bounds.emplace_back(i);
+        }
+        bounds.emplace_back(records.size());
+
+        std::vector<std::future<void>> futures;
+        for (std::uint32_t i = 0; i + 1 < bounds.size(); ++i) {
+            futures.emplace_back(std::async(std::launch::async, [&, i] () {
+                std::stable_sort(records.begin() + bounds[i],
+                    records.begin() + bounds[i + 1], less);
+            }));
+        }
+        for (auto& it: futures) {
+            it.get();
         }
 
-        dst.emplace_back(std::unique_ptr<T>(new T(q_name, q_name_length,
-            flag, t_name, t_name_length, t_begin, mapping_quality,
-            cigar, cigar_length, t_next_name, t_next_name_length,
-            t_next_begin, template_length, sequence, sequence_length,
-            quality, quality_length)));
+        for (std::uint64_t width = 1; width + 1 < bounds.size(); width *= 2) {
+            for (std::uint64_t i = 0; i + width + 1 < bounds.size();
+                i += 2 * width) {
 
-        ++num_objects;
-        current_bytes = 0;
-        line_length = 0;
+                auto last = std::min<std::uint64_t>(i + 2 * width,
+                    bounds.size() - 1);
+                std::inplace_merge(records.begin() + bounds[i],
+                    records.begin() + bounds[i + width],
+                    records.begin() + bounds[last], less);
+            }
+        }
     };
 
-    while (!is_end) {
+    auto write = [num_threads] (const Records& records,
+        const std::string& path) -> void {
 
-        std::uint64_t read_bytes = gzfread(this->buffer_.data(), sizeof(char),
-            this->buffer_.size(), input_file);
-        is_end = gzeof(input_file);
+        auto writer = createWriter<W>(path);
+        writer->set_num_threads(num_threads);
+        for (const auto& it: records) {
+            it->write(*writer);
+        }
+        writer->flush();
+    };
 
-        total_bytes += read_bytes;
-        if (max_bytes != 0 && total_bytes > max_bytes) {
-            if (last_object_id == num_objects) {
-                throw std::invalid_argument("[bioparser::SamParser] error: "
-                    "too small chunk size!");
+    auto pos = output_path.rfind('/');
+    std::string output_directory = pos == std::string::npos ? "." :
+        output_path.substr(0, pos + 1);
+    std::string directory = options.directory.empty() ? output_directory :
+        options.directory;
+
+    // output is written next to output_path and renamed once complete, so
+    // that a failed sort does not leave a truncated file behind
+    bool is_compressed = output_path.size() > 3 &&
+        output_path.compare(output_path.size() - 3, 3, ".gz") == 0;
+    std::string partial_path = temporaryPath(output_directory,
+        is_compressed ? ".gz" : ".part");
+
+    auto finish = [&] () -> void {
+        if (std::rename(partial_path.c_str(), output_path.c_str()) != 0) {
+            // rename does not replace existing files on some platforms
+            std::remove(output_path.c_str());
+            if (std::rename(partial_path.c_str(), output_path.c_str()) != 0) {
+                throw std::invalid_argument("[bioparser::sortOverlaps] error: "
+                    "unable to rename " + partial_path + " to " +
+                    output_path + "!");
             }
-            gzseek(input_file, -(current_bytes + read_bytes), SEEK_CUR);
-            status = true;
-            break;
         }
+    };
 
-        for (std::uint32_t i = 0; i < read_bytes; ++i) {
+    auto parser = createParser<P, Record>(input_path);
 
-            auto c = this->buffer_[i];
-            ++current_bytes;
+    // runs are removed once merged, temporaries holds all of them for clean
+    // up on errors
+    std::vector<std::string> runs;
+    std::vector<std::string> temporaries;
+    std::future<void> spill;
 
-            if (c == '\n') {
-                if (line[0] == '@') {
-                    line_length = 0;
-                    current_bytes = 0;
+    try {
+        // runs are sorted and spilled while the next batch is parsed
+        while (true) {
+            Records records;
+            bool status = parser->parse(records, options.max_bytes);
+
+            if (!status && runs.empty()) {
+                sort(records);
+                write(records, partial_path);
+                finish();
+                return;
+            }
+
+            if (spill.valid()) {
+                spill.get();
+            }
+            runs.emplace_back(temporaryPath(directory,
+                SortFormat<P>::kExtension));
+            temporaries.emplace_back(runs.back());
+
+            auto run = std::make_shared<Records>(std::move(records));
+            auto path = runs.back();
+            spill = std::async(std::launch::async, [&sort, &write, run, path]
+                () -> void {
+                    sort(*run);
+                    write(*run, path);
+                });
+
+            if (!status) {
+                break;
+            }
+        }
+        spill.get();
+
+        // each run parser holds a read buffer and line storage besides its
+        // share of max_bytes, which bounds the number of runs merged at once
+        const std::uint64_t kRunSize = kBufferSize + 3 * kSSS + kMSS;
+        std::uint64_t max_runs = std::max<std::uint64_t>(2,
+            options.max_bytes / (2 * kRunSize));
+
+        // k-way merge of runs [first, last) with a heap of run indices, ties
+        // are taken from earlier runs first
+        auto merge = [&] (std::uint64_t first, std::uint64_t last,
+            const std::string& path) -> void {
+
+            std::uint64_t num_runs = last - first;
+            std::uint64_t max_bytes = std::max<std::uint64_t>(
+                options.max_bytes / (2 * num_runs), 2 * kBufferSize);
+
+            std::vector<std::unique_ptr<P<Record>>> parsers;
+            std::vector<Records> heads(num_runs);
+            std::vector<std::uint64_t> positions(num_runs, 0);
+            std::vector<bool> statuses(num_runs, true);
+
+            auto refill = [&] (std::uint32_t i) -> bool {
+                heads[i].clear();
+                positions[i] = 0;
+                while (heads[i].empty() && statuses[i]) {
+                    statuses[i] = parsers[i]->parse(heads[i], max_bytes);
+                }
+                return !heads[i].empty();
+            };
+
+            auto greater = [&] (std::uint32_t lhs, std::uint32_t rhs) -> bool {
+                const auto& l = heads[lhs][positions[lhs]];
+                const auto& r = heads[rhs][positions[rhs]];
+                return r->less(*l, by_target) ||
+                    (!l->less(*r, by_target) && lhs > rhs);
+            };
+
+            std::vector<std::uint32_t> heap;
+            for (std::uint32_t i = 0; i < num_runs; ++i) {
+                parsers.emplace_back(createParser<P, Record>(runs[first + i]));
+                if (refill(i)) {
+                    heap.emplace_back(i);
+                }
+            }
+            std::make_heap(heap.begin(), heap.end(), greater);
+
+            auto writer = createWriter<W>(path);
+            writer->set_num_threads(num_threads);
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), greater);
+                auto i = heap.back();
+                heads[i][positions[i]]->write(*writer);
+                heads[i][positions[i]].reset();
+
+                if (++positions[i] < heads[i].size() || refill(i)) {
+                    std::push_heap(heap.begin(), heap.end(), greater);
+                } else {
+                    heap.pop_back();
+                }
+            }
+            writer->flush();
+        };
+
+        // consecutive runs are merged in passes until one pass is left, so
+        // that the order of ties is kept
+        while (runs.size() > max_runs) {
+            std::vector<std::string> merged_runs;
+            for (std::uint64_t i = 0; i < runs.size(); i += max_runs) {
+                auto last = std::min<std::uint64_t>(i + max_runs, runs.size());
+                if (last - i == 1) {
+                    merged_runs.emplace_back(runs[i]);
                     continue;
                 }
-                create_T();
-            } else {
-                line[line_length++] = c;
-                if (line_length == this->storage_.size()) {
-                    this->storage_.resize(5 * kSSS + 2 * kLSS);
-                    line = &(this->storage_[0]);
+                merged_runs.emplace_back(temporaryPath(directory,
+                    SortFormat<P>::kExtension));
+                temporaries.emplace_back(merged_runs.back());
+                merge(i, last, merged_runs.back());
+                for (std::uint64_t j = i; j < last; ++j) {
+                    std::remove(runs[j].c_str());
                 }
             }
+            runs.swap(merged_runs);
         }
+        merge(0, runs.size(), partial_path);
 
-        if (is_end && current_bytes != 0) {
-            create_T();
+        finish();
+
+    } catch (...) {
+        if (spill.valid()) {
+            spill.wait();
         }
+        for (const auto& it: temporaries) {
+            std::remove(it.c_str());
+        }
+        std::remove(partial_path.c_str());
+        throw;
     }
 
-    return status;
-}
-
-template<class T>
-inline HLFastqParser<T>::HLFastqParser(gzFile input_file)
-        : Parser<T>(input_file, kSSS + 2 * kMSS) {
-}
-
-template<class T>
-inline HLFastqParser<T>::~HLFastqParser() {
-}
-
-KSEQ_INIT(gzFile, gzread)
-template<class T>
-inline bool HLFastqParser<T>::parse(std::vector<std::unique_ptr<T>>& dst,
-    std::uint64_t max_bytes, bool trim) {
-
-    auto input_file = this->input_file_.get();
-    kseq_t *seq;
-    seq = kseq_init(input_file);
-
-    while (kseq_read(seq) >= 0){
-        dst.emplace_back(std::unique_ptr<T>(new T(
-            (const char*) seq->name.s, seq->name.l,
-            (const char*) seq->seq.s, seq->seq.l,
-            (const char*) seq->qual.s, seq->qual.l))
-        );
+    for (const auto& it: temporaries) {
+        std::remove(it.c_str());
     }
-    return false; // break the user's parser loop
 }
 
 }
@@ -4,11 +4,26 @@
  * @brief Bioparser unit test source file
  */
 
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
 #include "bioparser_test_config.h"
 
 #include "bioparser/bioparser.hpp"
 #include "gtest/gtest.h"
 
+bool copy_file(const std::string& src, const std::string& dst) {
+    std::ifstream input(src, std::ios::binary);
+    std::ofstream output(dst, std::ios::binary);
+    output << input.rdbuf();
+    return input.good() && output.good();
+}
+
+bool file_exists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
 class Read {
 public:
     Read(const char* name, std::uint32_t name_length,
@@ -44,6 +59,50 @@ void reads_summary(std::uint32_t& name_size, std::uint32_t& sequence_size,
     }
 }
 
+class ReadHeader {
+public:
+    ReadHeader(const char* name, std::uint32_t name_length,
+        std::uint32_t sequence_length)
+            : name_(name, name_length), sequence_length_(sequence_length) {
+    }
+
+    ~ReadHeader() {}
+
+    std::string name_;
+    std::uint32_t sequence_length_;
+};
+
+class SequenceRead {
+public:
+    SequenceRead(const char* name, std::uint32_t name_length,
+        const char* sequence, std::uint32_t sequence_length)
+            : name_(name, name_length), sequence_(sequence, sequence_length) {
+    }
+
+    ~SequenceRead() {}
+
+    std::string name_;
+    std::string sequence_;
+};
+
+class ReservedRead {
+public:
+    ReservedRead(const char* name, std::uint32_t name_length,
+        std::uint32_t sequence_length)
+            : name_(name, name_length), sequence_() {
+        sequence_.reserve(sequence_length);
+    }
+
+    ~ReservedRead() {}
+
+    std::uint64_t size_in_bytes() const {
+        return sizeof(*this) + name_.capacity() + sequence_.capacity();
+    }
+
+    std::string name_;
+    std::string sequence_;
+};
+
 class Overlap {
 public:
     Overlap(std::uint64_t a_id,
@@ -151,6 +210,30 @@ void overlaps_summary(std::uint32_t& name_size, std::uint32_t& total_value,
     }
 }
 
+class InternedOverlap {
+public:
+    InternedOverlap(std::uint32_t q_id, std::uint32_t, std::uint32_t,
+        std::uint32_t, char, std::uint32_t t_id, std::uint32_t, std::uint32_t,
+        std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t)
+            : q_id_(q_id), t_id_(t_id) {
+    }
+
+    ~InternedOverlap() {}
+
+    std::uint32_t q_id_;
+    std::uint32_t t_id_;
+};
+
+class MhapOverlap {
+public:
+    MhapOverlap(std::uint64_t, std::uint64_t, double, std::uint32_t,
+        std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t,
+        std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t) {
+    }
+
+    ~MhapOverlap() {}
+};
+
 class Alignment {
 public:
     Alignment(const char* q_name, std::uint32_t q_name_length,
@@ -192,6 +275,88 @@ public:
     std::string quality_;
 };
 
+class TaggedAlignment: public Alignment {
+public:
+    TaggedAlignment(const char* q_name, std::uint32_t q_name_length,
+        std::uint32_t flag,
+        const char* t_name, std::uint32_t t_name_length,
+        std::uint32_t t_begin,
+        std::uint32_t mapping_quality,
+        const char* cigar, std::uint32_t cigar_length,
+        const char* t_next_name, std::uint32_t t_next_name_length,
+        std::uint32_t t_next_begin,
+        std::uint32_t template_length,
+        const char* sequence, std::uint32_t sequence_length,
+        const char* quality, std::uint32_t quality_length,
+        const bioparser::SamTags& tags)
+            : Alignment(q_name, q_name_length, flag, t_name, t_name_length,
+            t_begin, mapping_quality, cigar, cigar_length, t_next_name,
+            t_next_name_length, t_next_begin, template_length, sequence,
+            sequence_length, quality, quality_length),
+            num_tags_(tags.size()), edit_distance_(), divergence_(),
+            type_() {
+
+        tags.find("NM", edit_distance_);
+        tags.find("dv", divergence_);
+        const char* value;
+        std::uint32_t value_length;
+        char type;
+        if (tags.find("tp", type, value, value_length) && type == 'A') {
+            type_ = value[0];
+        }
+    }
+
+    ~TaggedAlignment() {}
+
+    std::uint32_t num_tags_;
+    std::int64_t edit_distance_;
+    double divergence_;
+    char type_;
+};
+
+class CigarAlignment {
+public:
+    CigarAlignment(const char*, std::uint32_t, std::uint32_t, const char*,
+        std::uint32_t, std::uint32_t, std::uint32_t,
+        const char* cigar, std::uint32_t cigar_length,
+        const char*, std::uint32_t, std::uint32_t, std::uint32_t, const char*,
+        std::uint32_t, const char*, std::uint32_t,
+        const bioparser::SamCigar& decoded)
+            : cigar_(cigar, cigar_length),
+            operations_(decoded.data(), decoded.data() + decoded.size()),
+            query_span_(decoded.query_span()),
+            target_span_(decoded.target_span()),
+            aligned_bases_(decoded.aligned_bases()),
+            insertions_(decoded.insertions()),
+            deletions_(decoded.deletions()) {
+    }
+
+    ~CigarAlignment() {}
+
+    std::string cigar_;
+    std::vector<std::uint32_t> operations_;
+    std::uint32_t query_span_;
+    std::uint32_t target_span_;
+    std::uint32_t aligned_bases_;
+    std::uint32_t insertions_;
+    std::uint32_t deletions_;
+};
+
+class ReferenceAlignment {
+public:
+    ReferenceAlignment(const char*, std::uint32_t, std::uint32_t,
+        std::uint32_t t_id, std::uint32_t, std::uint32_t, const char*,
+        std::uint32_t, std::uint32_t t_next_id, std::uint32_t, std::uint32_t,
+        const char*, std::uint32_t, const char*, std::uint32_t)
+            : t_id_(t_id), t_next_id_(t_next_id) {
+    }
+
+    ~ReferenceAlignment() {}
+
+    std::uint32_t t_id_;
+    std::uint32_t t_next_id_;
+};
+
 void alignments_summary(std::uint32_t& string_size, std::uint32_t& total_value,
     const std::vector<std::unique_ptr<Alignment>>& alignments) {
 
@@ -212,6 +377,105 @@ void alignments_summary(std::uint32_t& string_size, std::uint32_t& total_value,
     }
 }
 
+class GraphElement {
+public:
+    GraphElement(const char* name, std::uint32_t name_length,
+        const char* sequence, std::uint32_t sequence_length)
+            : type_('S'), name_(name, name_length),
+            sequence_(sequence, sequence_length), other_() {
+    }
+
+    GraphElement(const char* from, std::uint32_t from_length,
+        char from_orientation,
+        const char* to, std::uint32_t to_length,
+        char to_orientation,
+        const char* overlap, std::uint32_t overlap_length)
+            : type_('L'), name_(from, from_length), sequence_(),
+            other_(overlap, overlap_length) {
+        name_.append(to, to_length);
+        name_ += from_orientation;
+        name_ += to_orientation;
+    }
+
+    GraphElement(const char* name, std::uint32_t name_length,
+        const char* segments, std::uint32_t segments_length,
+        const char* overlaps, std::uint32_t overlaps_length)
+            : type_('P'), name_(name, name_length), sequence_(),
+            other_(segments, segments_length) {
+        other_.append(overlaps, overlaps_length);
+    }
+
+    ~GraphElement() {}
+
+    char type_;
+    std::string name_;
+    std::string sequence_;
+    std::string other_;
+};
+
+void graph_summary(std::uint32_t& num_segments, std::uint32_t& num_links,
+    std::uint32_t& num_paths, std::uint32_t& name_size,
+    std::uint32_t& sequence_size, std::uint32_t& other_size,
+    const std::vector<std::unique_ptr<GraphElement>>& elements) {
+
+    num_segments = 0;
+    num_links = 0;
+    num_paths = 0;
+    name_size = 0;
+    sequence_size = 0;
+    other_size = 0;
+    for (const auto& it: elements) {
+        switch (it->type_) {
+            case 'S': ++num_segments; break;
+            case 'L': ++num_links; name_size -= 2; break;
+            default: ++num_paths; break;
+        }
+        name_size += it->name_.size();
+        sequence_size += it->sequence_.size();
+        other_size += it->other_.size();
+    }
+}
+
+class Interval {
+public:
+    Interval(const char* chromosome, std::uint32_t chromosome_length,
+        std::uint32_t begin, std::uint32_t end,
+        const char* name, std::uint32_t name_length,
+        std::uint32_t score, char strand)
+            : chromosome_(chromosome, chromosome_length), begin_(begin),
+            end_(end), name_(name, name_length), score_(score),
+            strand_(strand) {
+    }
+
+    ~Interval() {}
+
+    std::string chromosome_;
+    std::uint32_t begin_;
+    std::uint32_t end_;
+    std::string name_;
+    std::uint32_t score_;
+    char strand_;
+};
+
+void intervals_summary(std::uint32_t& chromosome_size, std::uint32_t& length,
+    std::uint32_t& name_size, std::uint32_t& score,
+    std::uint32_t& num_reverse,
+    const std::vector<std::unique_ptr<Interval>>& intervals) {
+
+    chromosome_size = 0;
+    length = 0;
+    name_size = 0;
+    score = 0;
+    num_reverse = 0;
+    for (const auto& it: intervals) {
+        chromosome_size += it->chromosome_.size();
+        length += it->end_ - it->begin_;
+        name_size += it->name_.size();
+        score += it->score_;
+        num_reverse += it->strand_ == '-';
+    }
+}
+
 class BioparserFastaTest: public ::testing::Test {
 public:
     void SetUp(const std::string& file_name) {
@@ -220,7 +484,7 @@ public:
 
     void TearDown() {}
 
-    std::unique_ptr<bioparser::Parser<Read>> parser;
+    std::unique_ptr<bioparser::FastaParser<Read>> parser;
 };
 
 class BioparserFastqTest: public ::testing::Test {
@@ -267,6 +531,50 @@ public:
     std::unique_ptr<bioparser::Parser<Alignment>> parser;
 };
 
+class BioparserBamTest: public ::testing::Test {
+public:
+    void SetUp(const std::string& file_name) {
+        parser = bioparser::createParser<bioparser::BamParser, Alignment>(file_name);
+    }
+
+    void TearDown() {}
+
+    std::unique_ptr<bioparser::Parser<Alignment>> parser;
+};
+
+class BioparserGfaTest: public ::testing::Test {
+public:
+    void SetUp(const std::string& file_name) {
+        parser = bioparser::createParser<bioparser::GfaParser, GraphElement>(file_name);
+    }
+
+    void TearDown() {}
+
+    std::unique_ptr<bioparser::GfaParser<GraphElement>> parser;
+};
+
+class BioparserTwoBitTest: public ::testing::Test {
+public:
+    void SetUp(const std::string& file_name) {
+        parser = bioparser::createParser<bioparser::TwoBitParser, Read>(file_name);
+    }
+
+    void TearDown() {}
+
+    std::unique_ptr<bioparser::TwoBitParser<Read>> parser;
+};
+
+class BioparserBedTest: public ::testing::Test {
+public:
+    void SetUp(const std::string& file_name) {
+        parser = bioparser::createParser<bioparser::BedParser, Interval>(file_name);
+    }
+
+    void TearDown() {}
+
+    std::unique_ptr<bioparser::BedParser<Interval>> parser;
+};
+
 TEST(BioparserTest, CreateParserError) {
     try {
         auto parser = bioparser::createParser<bioparser::FastaParser, Read>("");
@@ -376,6 +684,84 @@ TEST_F(BioparserFastaTest, CompressedParseInChunks) {
     EXPECT_EQ(0U, quality_size);
 }
 
+TEST_F(BioparserFastaTest, StreamInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.fasta.gz");
+
+    std::vector<std::unique_ptr<Read>> reads;
+    parser->parse(reads, -1);
+
+    SetUp(bioparser_test_data_path + "sample.fasta.gz");
+
+    std::vector<std::string> names, sequences;
+    std::uint32_t num_last_chunks = 0;
+    auto header = [&] (const char* name, std::uint32_t name_length) -> void {
+        names.emplace_back(name, name_length);
+        sequences.emplace_back();
+    };
+    auto chunk = [&] (const char* sequence, std::uint32_t sequence_length,
+        bool is_last) -> void {
+        sequences.back().append(sequence, sequence_length);
+        num_last_chunks += is_last;
+    };
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    while (parser->stream(size_in_bytes, header, chunk)) {
+    }
+
+    EXPECT_EQ(14U, names.size());
+    EXPECT_EQ(14U, num_last_chunks);
+    for (std::uint32_t i = 0; i < reads.size() && i < names.size(); ++i) {
+        EXPECT_EQ(reads[i]->name_, names[i]);
+        EXPECT_EQ(reads[i]->sequence_, sequences[i]);
+    }
+}
+
+TEST_F(BioparserFastaTest, StreamNameWithLeadingWhitespace) {
+
+    std::string path = "bioparser_stream_whitespace.fasta";
+    std::ofstream(path) << ">  r1 description\nACGT\n>\tr2\nAC\n";
+
+    SetUp(path);
+
+    std::vector<std::string> names;
+    parser->stream(-1, [&] (const char* name, std::uint32_t name_length) {
+        names.emplace_back(name, name_length);
+    }, [] (const char*, std::uint32_t, bool) {});
+
+    ASSERT_EQ(2U, names.size());
+    EXPECT_EQ("r1", names[0]);
+    EXPECT_EQ("r2", names[1]);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserFastaTest, StreamCarriageReturnAtChunkBoundary) {
+
+    // the first carriage return is the last byte of a full chunk
+    std::string line(bioparser::kMSS - 1, 'A');
+    std::string path = "bioparser_stream_crlf.fasta";
+    std::ofstream(path, std::ios::binary) << ">r1\r\n" << line << "\r\n" <<
+        "CG\r\n>r2\r\nT\r\n";
+
+    SetUp(path);
+
+    std::vector<std::string> sequences(1);
+    parser->stream(-1, [] (const char*, std::uint32_t) {},
+        [&] (const char* sequence, std::uint32_t sequence_length,
+            bool is_last) {
+            sequences.back().append(sequence, sequence_length);
+            if (is_last) {
+                sequences.emplace_back();
+            }
+        });
+    std::remove(path.c_str());
+
+    ASSERT_EQ(3U, sequences.size());
+    EXPECT_EQ(line + "CG", sequences[0]);
+    EXPECT_EQ("T", sequences[1]);
+}
+
 TEST_F(BioparserFastaTest, FormatError) {
 
     SetUp(bioparser_test_data_path + "sample.fastq");
@@ -402,6 +788,20 @@ TEST_F(BioparserFastaTest, CompressedFormatError) {
     }
 }
 
+TEST_F(BioparserFastaTest, StreamFormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq");
+
+    try {
+        parser->stream(-1, [] (const char*, std::uint32_t) {},
+            [] (const char*, std::uint32_t, bool) {});
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::FastaParser] error: "
+            "invalid file format!");
+    }
+}
+
 TEST_F(BioparserFastaTest, ChunkSizeError) {
 
     SetUp(bioparser_test_data_path + "sample.fasta");
@@ -411,7 +811,7 @@ TEST_F(BioparserFastaTest, ChunkSizeError) {
 
     try {
         parser->parse(reads, size_in_bytes);
-    } catch (std::invalid_argument& exception) {
+    } catch (bioparser::ChunkSizeError& exception) {
         EXPECT_STREQ(exception.what(), "[bioparser::FastaParser] error: "
             "too small chunk size!");
     }
@@ -426,7 +826,7 @@ TEST_F(BioparserFastaTest, CompressedChunkSizeError) {
 
     try {
         parser->parse(reads, size_in_bytes);
-    } catch (std::invalid_argument& exception) {
+    } catch (bioparser::ChunkSizeError& exception) {
         EXPECT_STREQ(exception.what(), "[bioparser::FastaParser] error: "
             "too small chunk size!");
     }
@@ -486,64 +886,86 @@ TEST_F(BioparserFastaTest, CompressedParseAndReset) {
     EXPECT_EQ(quality_size_new, quality_size);
 }
 
-TEST_F(BioparserFastqTest, ParseWhole) {
+TEST_F(BioparserFastaTest, ParseSingleLineInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.fastq");
+    SetUp(bioparser_test_data_path + "sample_single_line.fasta");
 
+    std::uint32_t size_in_bytes = 64 * 1024;
     std::vector<std::unique_ptr<Read>> reads;
-    parser->parse(reads, -1);
+    while (parser->parse(reads, size_in_bytes)) {
+    }
 
     std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
     reads_summary(name_size, sequence_size, quality_size, reads);
 
-    EXPECT_EQ(13U, reads.size());
-    EXPECT_EQ(17U, name_size);
-    EXPECT_EQ(108140U, sequence_size);
-    EXPECT_EQ(108140U, quality_size);
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_EQ(65U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(0U, quality_size);
 }
 
-TEST_F(BioparserFastqTest, CompressedParseWhole) {
+TEST_F(BioparserFastaTest, ParseFiltered) {
 
-    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+    bioparser::ReadFilter filter;
+    filter.min_length = 3000;
+    filter.max_length = 8600;
+    filter.max_n_fraction = 0;
 
-    std::vector<std::unique_ptr<Read>> reads;
-    parser->parse(reads, -1);
+    for (const auto& it: {"sample.fasta", "sample_single_line.fasta"}) {
+        SetUp(bioparser_test_data_path + it);
+        parser->set_filter(filter);
 
-    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
-    reads_summary(name_size, sequence_size, quality_size, reads);
+        std::vector<std::unique_ptr<Read>> reads;
+        parser->parse(reads, -1);
 
-    EXPECT_EQ(13U, reads.size());
-    EXPECT_EQ(17U, name_size);
-    EXPECT_EQ(108140U, sequence_size);
-    EXPECT_EQ(108140U, quality_size);
+        std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+        reads_summary(name_size, sequence_size, quality_size, reads);
+
+        EXPECT_EQ(7U, reads.size());
+        EXPECT_EQ(46201U, sequence_size);
+    }
 }
 
-TEST_F(BioparserFastqTest, ParseInChunks) {
+TEST_F(BioparserFastaTest, ParseWithBaseLimit) {
 
-    SetUp(bioparser_test_data_path + "sample.fastq");
+    SetUp(bioparser_test_data_path + "sample.fasta");
+
+    bioparser::BatchLimits limits;
+    limits.max_bases = 20000;
+    parser->set_limits(limits);
 
-    std::uint32_t size_in_bytes = 64 * 1024;
     std::vector<std::unique_ptr<Read>> reads;
-    while (parser->parse(reads, size_in_bytes)) {
+    while (true) {
+        auto num_reads = reads.size();
+        auto status = parser->parse(reads, -1);
+
+        std::uint64_t num_bases = 0;
+        for (auto i = num_reads; i < reads.size(); ++i) {
+            num_bases += reads[i]->sequence_.size();
+        }
+        if (!status) {
+            break;
+        }
+        // batches end with the record which reaches the limit
+        EXPECT_GE(num_bases, limits.max_bases);
+        EXPECT_LT(num_bases - reads.back()->sequence_.size(), limits.max_bases);
     }
 
     std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
     reads_summary(name_size, sequence_size, quality_size, reads);
 
-    EXPECT_EQ(13U, reads.size());
-    EXPECT_EQ(17U, name_size);
-    EXPECT_EQ(108140U, sequence_size);
-    EXPECT_EQ(108140U, quality_size);
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_EQ(65U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(0U, quality_size);
 }
 
-TEST_F(BioparserFastqTest, CompressedParseInChunks) {
+TEST_F(BioparserFastqTest, ParseWhole) {
 
-    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+    SetUp(bioparser_test_data_path + "sample.fastq");
 
-    std::uint32_t size_in_bytes = 64 * 1024;
     std::vector<std::unique_ptr<Read>> reads;
-    while (parser->parse(reads, size_in_bytes)) {
-    }
+    parser->parse(reads, -1);
 
     std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
     reads_summary(name_size, sequence_size, quality_size, reads);
@@ -554,336 +976,2495 @@ TEST_F(BioparserFastqTest, CompressedParseInChunks) {
     EXPECT_EQ(108140U, quality_size);
 }
 
-TEST_F(BioparserFastqTest, FormatError) {
+TEST_F(BioparserFastqTest, ParseFiltered) {
 
-    SetUp(bioparser_test_data_path + "sample.fasta");
+    bioparser::ReadFilter filter;
+    filter.min_length = 2000;
+    filter.max_length = 12000;
+    filter.min_mean_quality = 10;
 
-    std::vector<std::unique_ptr<Read>> reads;
+    for (const auto& it: {std::make_pair("sample.fastq", 21436U),
+        std::make_pair("sample_wrapped_quality.fastq", 32028U)}) {
 
-    try {
-        parser->parse(reads, -1);
-    } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
-            "invalid file format!");
+        SetUp(bioparser_test_data_path + it.first);
+        static_cast<bioparser::FastqParser<Read>*>(parser.get())->set_filter(
+            filter);
+
+        std::uint32_t size_in_bytes = 64 * 1024;
+        std::vector<std::unique_ptr<Read>> reads;
+        while (parser->parse(reads, size_in_bytes)) {
+        }
+
+        std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+        reads_summary(name_size, sequence_size, quality_size, reads);
+
+        EXPECT_EQ(it.second, sequence_size);
+        EXPECT_EQ(it.second, quality_size);
+        for (const auto& jt: reads) {
+            EXPECT_LE(2000U, jt->sequence_.size());
+            EXPECT_GE(12000U, jt->sequence_.size());
+        }
     }
 }
 
-TEST_F(BioparserFastqTest, CompressedFormatError) {
+TEST(BioparserHeaderTest, ParseHeadersInChunks) {
+
+    for (const auto& it: {"sample.fasta", "sample_single_line.fasta",
+        "sample.fastq", "sample_wrapped_quality.fastq", "sample.fastq.gz"}) {
+
+        std::string path = bioparser_test_data_path + it;
+        bool is_fasta = path.find(".fasta") != std::string::npos;
+
+        std::vector<std::unique_ptr<Read>> reads;
+        std::vector<std::unique_ptr<ReadHeader>> headers;
+        if (is_fasta) {
+            bioparser::createParser<bioparser::FastaParser, Read>(path)->parse(
+                reads, -1);
+            auto parser = bioparser::createParser<bioparser::FastaParser,
+                ReadHeader>(path);
+            while (parser->parse(headers, 64 * 1024)) {
+            }
+        } else {
+            bioparser::createParser<bioparser::FastqParser, Read>(path)->parse(
+                reads, -1);
+            auto parser = bioparser::createParser<bioparser::FastqParser,
+                ReadHeader>(path);
+            while (parser->parse(headers, 64 * 1024)) {
+            }
+        }
+
+        ASSERT_EQ(reads.size(), headers.size());
+        for (std::uint32_t i = 0; i < reads.size(); ++i) {
+            EXPECT_EQ(reads[i]->name_, headers[i]->name_);
+            EXPECT_EQ(reads[i]->sequence_.size(), headers[i]->sequence_length_);
+        }
+    }
+}
 
-    SetUp(bioparser_test_data_path + "sample.fasta.gz");
+TEST_F(BioparserFastqTest, ParseWithoutQualities) {
 
-    std::vector<std::unique_ptr<Read>> reads;
+    for (const auto& it: {"sample.fastq", "sample_wrapped_quality.fastq",
+        "sample.fastq.gz"}) {
 
-    try {
+        SetUp(bioparser_test_data_path + it);
+
+        std::vector<std::unique_ptr<Read>> reads;
         parser->parse(reads, -1);
-    } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
-            "invalid file format!");
+
+        auto sequence_parser = bioparser::createParser<bioparser::FastqParser,
+            SequenceRead>(bioparser_test_data_path + it);
+
+        std::vector<std::unique_ptr<SequenceRead>> sequences;
+        while (sequence_parser->parse(sequences, 64 * 1024)) {
+        }
+
+        ASSERT_EQ(reads.size(), sequences.size());
+        for (std::uint32_t i = 0; i < reads.size(); ++i) {
+            EXPECT_EQ(reads[i]->name_, sequences[i]->name_);
+            EXPECT_EQ(reads[i]->sequence_, sequences[i]->sequence_);
+        }
     }
 }
 
-TEST_F(BioparserFastqTest, ChunkSizeError) {
+TEST(BioparserStaticTest, ParseInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.fastq");
+    bioparser::StaticParser<bioparser::FastqParser, Read> parser(
+        bioparser_test_data_path + "sample.fastq");
 
-    std::uint32_t size_in_bytes = 10 * 1024;
+    std::uint32_t size_in_bytes = 64 * 1024;
     std::vector<std::unique_ptr<Read>> reads;
+    while (parser.parse(reads, size_in_bytes)) {
+    }
 
-    try {
-        parser->parse(reads, size_in_bytes);
-    } catch (std::invalid_argument& exception) {
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+
+    bioparser::ReadFilter filter;
+    filter.min_length = 2000;
+    filter.max_length = 12000;
+    filter.min_mean_quality = 10;
+
+    parser.reset();
+    parser->set_filter(filter);
+    reads.clear();
+    parser.parse(reads, -1);
+
+    reads_summary(name_size, sequence_size, quality_size, reads);
+    EXPECT_EQ(21436U, sequence_size);
+}
+
+TEST(BioparserStaticTest, ParseWithOptions) {
+
+    bioparser::StaticParser<bioparser::FastaParser, Read,
+        bioparser::ParseOptions<bioparser::Trim::kSoft>> fasta_parser(
+            bioparser_test_data_path + "sample.fasta");
+
+    std::vector<std::unique_ptr<Read>> reads;
+    fasta_parser.parse(reads, -1);
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_EQ(75U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+
+    // formats without compiled options take the trim policy at run time
+    bioparser::StaticParser<bioparser::PafParser, Overlap,
+        bioparser::ParseOptions<bioparser::Trim::kSoft>> paf_parser(
+            bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    paf_parser.parse(overlaps, -1);
+    EXPECT_EQ(500U, overlaps.size());
+}
+
+TEST(BioparserStaticTest, MinimalValidation) {
+
+    // second record is empty
+    std::string path = "bioparser_minimal_validation.fastq";
+    std::ofstream(path) << "@r1\nACGT\n+\n!!!!\n@r2\n\n+\n\n";
+
+    bioparser::StaticParser<bioparser::FastqParser, Read,
+        bioparser::ParseOptions<bioparser::Trim::kHard,
+        bioparser::Validation::kMinimal>> minimal_parser(path);
+
+    std::vector<std::unique_ptr<Read>> reads;
+    minimal_parser.parse(reads, -1);
+
+    ASSERT_EQ(2U, reads.size());
+    EXPECT_EQ("ACGT", reads[0]->sequence_);
+    EXPECT_EQ("r2", reads[1]->name_);
+    EXPECT_TRUE(reads[1]->sequence_.empty());
+
+    bioparser::StaticParser<bioparser::FastqParser, Read> full_parser(path);
+    reads.clear();
+    try {
+        full_parser.parse(reads, -1);
+        ADD_FAILURE();
+    } catch (const std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
+            "invalid file format!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserFastqTest, CompressedParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+
+    std::vector<std::unique_ptr<Read>> reads;
+    parser->parse(reads, -1);
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST_F(BioparserFastqTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST_F(BioparserFastqTest, CompressedParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST_F(BioparserFastqTest, CompressedParseWithRecordLimit) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+
+    bioparser::BatchLimits limits;
+    limits.max_records = 4;
+    parser->set_limits(limits);
+
+    std::vector<std::uint32_t> batch_sizes;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (true) {
+        auto num_reads = reads.size();
+        auto status = parser->parse(reads, -1);
+        batch_sizes.emplace_back(reads.size() - num_reads);
+        if (!status) {
+            break;
+        }
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(std::vector<std::uint32_t>({4, 4, 4, 1}), batch_sizes);
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST_F(BioparserFastqTest, ParseWithMemoryLimit) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq");
+
+    bioparser::BatchLimits limits;
+    limits.max_memory = 32 * 1024;
+    parser->set_limits(limits);
+
+    // sizeof(T) plus the lengths of strings passed to the constructor
+    auto memory_size = [] (const std::unique_ptr<Read>& read) -> std::uint64_t {
+        return sizeof(read) + sizeof(Read) + read->name_.size() +
+            read->sequence_.size() + read->quality_.size();
+    };
+
+    std::vector<std::unique_ptr<Read>> reads;
+    while (true) {
+        auto num_reads = reads.size();
+        auto status = parser->parse(reads, -1);
+
+        std::uint64_t batch_size = 0;
+        for (auto i = num_reads; i < reads.size(); ++i) {
+            batch_size += memory_size(reads[i]);
+        }
+        if (!status) {
+            break;
+        }
+        EXPECT_GE(batch_size, limits.max_memory);
+        EXPECT_LT(batch_size - memory_size(reads.back()), limits.max_memory);
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST(BioparserMemoryTest, ParseWithSizeHook) {
+
+    auto parser = bioparser::createParser<bioparser::FastaParser, ReservedRead>(
+        bioparser_test_data_path + "sample.fasta");
+
+    // sequences are not passed to the constructor, but are reserved
+    bioparser::BatchLimits limits;
+    limits.max_memory = 32 * 1024;
+    parser->set_limits(limits);
+
+    auto memory_size = [] (const std::unique_ptr<ReservedRead>& read)
+        -> std::uint64_t {
+        return sizeof(read) + read->size_in_bytes();
+    };
+
+    std::uint32_t num_batches = 0;
+    std::uint64_t sequence_size = 0;
+    std::vector<std::unique_ptr<ReservedRead>> reads;
+    while (true) {
+        ++num_batches;
+        auto num_reads = reads.size();
+        auto status = parser->parse(reads, -1);
+
+        std::uint64_t batch_size = 0;
+        for (auto i = num_reads; i < reads.size(); ++i) {
+            batch_size += memory_size(reads[i]);
+            sequence_size += reads[i]->sequence_.capacity();
+        }
+        if (!status) {
+            break;
+        }
+        EXPECT_GE(batch_size, limits.max_memory);
+        EXPECT_LT(batch_size - memory_size(reads.back()), limits.max_memory);
+    }
+
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_LE(109117U, sequence_size);
+    EXPECT_LT(1U, num_batches);
+}
+
+TEST_F(BioparserFastqTest, ParseSingleLineInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample_single_line.fastq");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+}
+
+TEST_F(BioparserFastqTest, ParseWrappedQualityMarkersInChunks) {
+
+    // every wrapped quality line starts with either '@' or '+'
+    SetUp(bioparser_test_data_path + "sample_wrapped_quality.fastq");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(13U, reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+    for (const auto& it: reads) {
+        EXPECT_EQ('@', it->quality_[0]);
+        EXPECT_EQ(it->sequence_.size(), it->quality_.size());
+    }
+}
+
+TEST_F(BioparserFastqTest, FormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.fasta");
+
+    std::vector<std::unique_ptr<Read>> reads;
+
+    try {
+        parser->parse(reads, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserFastqTest, CompressedFormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.fasta.gz");
+
+    std::vector<std::unique_ptr<Read>> reads;
+
+    try {
+        parser->parse(reads, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserFastqTest, ChunkSizeError) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq");
+
+    std::uint32_t size_in_bytes = 10 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+
+    try {
+        parser->parse(reads, size_in_bytes);
+    } catch (bioparser::ChunkSizeError& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
+            "too small chunk size!");
+    }
+}
+
+TEST_F(BioparserFastqTest, CompressedChunkSizeError) {
+
+    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+
+    std::uint32_t size_in_bytes = 10 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+
+    try {
+        parser->parse(reads, size_in_bytes);
+    } catch (bioparser::ChunkSizeError& exception) {
         EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
             "too small chunk size!");
     }
-}
+}
+
+TEST_F(BioparserFastqTest, ParseWithCache) {
+
+    std::string path = "bioparser_cache_sample.fastq.gz";
+    ASSERT_TRUE(copy_file(bioparser_test_data_path + "sample.fastq.gz", path));
+    std::remove((path + ".bpc").c_str());
+
+    SetUp(path);
+    parser->enable_cache();
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+    EXPECT_TRUE(file_exists(path + ".bpc"));
+
+    SetUp(path);
+    parser->enable_cache();
+
+    std::vector<std::unique_ptr<Read>> cached_reads;
+    while (parser->parse(cached_reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, cached_reads);
+
+    EXPECT_EQ(13U, cached_reads.size());
+    EXPECT_EQ(17U, name_size);
+    EXPECT_EQ(108140U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
+    for (std::uint32_t i = 0; i < reads.size() && i < cached_reads.size(); ++i) {
+        EXPECT_EQ(reads[i]->quality_, cached_reads[i]->quality_);
+    }
+
+    cached_reads.clear();
+    parser->reset();
+    parser->parse(cached_reads, -1);
+    EXPECT_EQ(13U, cached_reads.size());
+
+    std::remove((path + ".bpc").c_str());
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserMhapTest, ParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(150U, overlaps.size());
+    EXPECT_EQ(0U, name_size);
+    EXPECT_EQ(7822873U, total_value);
+}
+
+TEST_F(BioparserMhapTest, ParseFiltered) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    bioparser::OverlapFilter filter;
+    filter.min_length = 1000;
+    filter.min_identity = 0.78;
+    filter.remove_self_overlaps = true;
+    static_cast<bioparser::MhapParser<Overlap>*>(parser.get())->set_filter(
+        filter);
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    EXPECT_EQ(80U, overlaps.size());
+    for (const auto& it: overlaps) {
+        EXPECT_NE(it->q_id_, it->t_id_);
+        EXPECT_GE(std::max(it->q_end_ - it->q_begin_, it->t_end_ - it->t_begin_),
+            1000U);
+    }
+}
+
+TEST_F(BioparserMhapTest, FilteredFormatError) {
+
+    // the self overlap is rejected after two columns
+    std::string path = "bioparser_filtered_error.mhap";
+    std::ofstream(path) << "1 1 0.1 5\n";
+
+    SetUp(path);
+
+    bioparser::OverlapFilter filter;
+    filter.remove_self_overlaps = true;
+    static_cast<bioparser::MhapParser<Overlap>*>(parser.get())->set_filter(
+        filter);
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    try {
+        parser->parse(overlaps, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
+            "invalid file format!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserMhapTest, ParseIntoStoreInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    auto store_parser = bioparser::createParser<bioparser::MhapParser,
+        Overlap>(bioparser_test_data_path + "sample.mhap");
+
+    // small batches are merged into the store in bulk
+    bioparser::BatchLimits limits;
+    limits.max_records = 10;
+    store_parser->set_limits(limits);
+
+    // overlaps pending a merge count towards the size
+    bioparser::OverlapStore store;
+    std::uint32_t num_batches = 0, num_pending_batches = 0;
+    std::uint64_t merged_size = 0;
+    while (store_parser->parse(store, -1)) {
+        ++num_batches;
+        std::uint64_t num_pending = 10 * num_batches - store.size();
+        if (num_pending == 0) {
+            merged_size = store.size_in_bytes();
+        } else {
+            ++num_pending_batches;
+        }
+        EXPECT_LE(merged_size + num_pending *
+            sizeof(bioparser::OverlapStore::Record), store.size_in_bytes());
+    }
+    EXPECT_LT(0U, num_pending_batches);
+
+    EXPECT_EQ(14U, num_batches);
+
+    EXPECT_EQ(overlaps.size(), store.size());
+    EXPECT_EQ(nullptr, store.names());
+
+    std::vector<bioparser::OverlapStore::Record> expected;
+    for (const auto& it: overlaps) {
+        bioparser::OverlapStore::Record record = {
+            static_cast<std::uint32_t>(it->q_id_ + 1), it->q_length_,
+            it->q_begin_, it->q_end_, it->orientation_,
+            static_cast<std::uint32_t>(it->t_id_ + 1), it->t_length_,
+            it->t_begin_, it->t_end_, 0, std::max(it->q_end_ - it->q_begin_,
+            it->t_end_ - it->t_begin_), 255};
+        // error is stored in 1e-4 units
+        record.matching_bases = (1 - it->error_ / 10000.) *
+            record.block_length + 0.5;
+        expected.emplace_back(record);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+        [] (const bioparser::OverlapStore::Record& lhs,
+            const bioparser::OverlapStore::Record& rhs) -> bool {
+            return lhs.q_id < rhs.q_id || (lhs.q_id == rhs.q_id &&
+                (lhs.t_id < rhs.t_id || (lhs.t_id == rhs.t_id &&
+                lhs.q_begin < rhs.q_begin)));
+        });
+
+    std::uint32_t i = 0;
+    for (const auto& it: store) {
+        ASSERT_LT(i, expected.size());
+        const auto& jt = expected[i++];
+        EXPECT_EQ(jt.q_id, it.q_id);
+        EXPECT_EQ(jt.q_length, it.q_length);
+        EXPECT_EQ(jt.q_begin, it.q_begin);
+        EXPECT_EQ(jt.q_end, it.q_end);
+        EXPECT_EQ(jt.orientation, it.orientation);
+        EXPECT_EQ(jt.t_id, it.t_id);
+        EXPECT_EQ(jt.t_length, it.t_length);
+        EXPECT_EQ(jt.t_begin, it.t_begin);
+        EXPECT_EQ(jt.t_end, it.t_end);
+        EXPECT_NEAR(jt.matching_bases, it.matching_bases,
+            1e-4 * jt.block_length + 1);
+        EXPECT_EQ(jt.block_length, it.block_length);
+        EXPECT_EQ(jt.mapping_quality, it.mapping_quality);
+    }
+    EXPECT_EQ(overlaps.size(), i);
+}
+
+TEST_F(BioparserMhapTest, ParseIntoStoreIdError) {
+
+    std::string path = "bioparser_store_id_error.mhap";
+    std::ofstream(path) << "1 4294967296 0.1 5 0 0 10 10 0 0 10 10\n";
+
+    auto store_parser = bioparser::createParser<bioparser::MhapParser,
+        Overlap>(path);
+
+    bioparser::OverlapStore store;
+    try {
+        store_parser->parse(store, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
+            "read id 4294967296 does not fit into the overlap store!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserMhapTest, CompressedWriteAndParse) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::string path = "bioparser_writer_sample.mhap.gz";
+    {
+        auto writer = bioparser::createWriter<bioparser::MhapWriter>(path);
+        writer->set_num_threads(4);
+        for (const auto& it: overlaps) {
+            // error is stored in 1e-4 units
+            writer->write(it->q_id_ + 1, it->t_id_ + 1,
+                (it->error_ + 0.5) / 10000, it->minmers_, 0, it->q_begin_,
+                it->q_end_, it->q_length_, it->orientation_ == '-',
+                it->t_begin_, it->t_end_, it->t_length_);
+        }
+    }
+
+    SetUp(path);
+
+    overlaps.clear();
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(150U, overlaps.size());
+    EXPECT_EQ(0U, name_size);
+    EXPECT_EQ(7822873U, total_value);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserMhapTest, WriteErrorRoundTrip) {
+
+    std::vector<double> errors = { 0.1, 0.123456789, 1.0 / 3,
+        0.00012345678901234567, 2.5e-10 };
+
+    std::string path = "bioparser_writer_error.mhap";
+    {
+        auto writer = bioparser::createWriter<bioparser::MhapWriter>(path);
+        for (const auto& it: errors) {
+            writer->write(1, 2, it, 3, 0, 0, 10, 10, 0, 0, 10, 10);
+        }
+    }
+
+    std::vector<std::string> lines;
+    std::ifstream input(path);
+    for (std::string line; std::getline(input, line);) {
+        lines.emplace_back(line);
+    }
+
+    // errors are the third column and read back exactly
+    ASSERT_EQ(errors.size(), lines.size());
+    EXPECT_EQ("1 2 0.1 3 0 0 10 10 0 0 10 10", lines[0]);
+    for (std::uint32_t i = 0; i < errors.size(); ++i) {
+        auto begin = lines[i].find(' ', lines[i].find(' ') + 1) + 1;
+        EXPECT_EQ(errors[i], std::strtod(&lines[i][begin], nullptr));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserMhapTest, SortExternallyByTarget) {
+
+    // sample repeated into three runs of at most 64 KiB, which are merged in
+    // two passes
+    std::string input_path = "bioparser_sort_sample.mhap";
+    {
+        std::ifstream input(bioparser_test_data_path + "sample.mhap");
+        std::string content((std::istreambuf_iterator<char>(input)),
+            std::istreambuf_iterator<char>());
+        std::ofstream output(input_path);
+        for (std::uint32_t i = 0; i < 20; ++i) {
+            output << content;
+        }
+    }
+
+    SetUp(input_path);
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+    EXPECT_EQ(3000U, overlaps.size());
+
+    bioparser::SortOptions options;
+    options.by_target = true;
+    options.max_bytes = 64 * 1024;
+    options.num_threads = 2;
+    options.directory = ".";
+
+    std::string path = "bioparser_sorted_sample.mhap";
+    bioparser::sortOverlaps<bioparser::MhapParser>(input_path, path, options);
+    std::remove(input_path.c_str());
+
+    std::vector<std::unique_ptr<Overlap>> sorted_overlaps;
+    bioparser::createParser<bioparser::MhapParser, Overlap>(path)->parse(
+        sorted_overlaps, -1);
+    std::remove(path.c_str());
+
+    std::stable_sort(overlaps.begin(), overlaps.end(),
+        [] (const std::unique_ptr<Overlap>& lhs,
+            const std::unique_ptr<Overlap>& rhs) -> bool {
+            return std::tie(lhs->t_id_, lhs->q_id_, lhs->t_begin_,
+                lhs->q_begin_) < std::tie(rhs->t_id_, rhs->q_id_,
+                rhs->t_begin_, rhs->q_begin_);
+        });
+
+    ASSERT_EQ(overlaps.size(), sorted_overlaps.size());
+    for (std::uint32_t i = 0; i < overlaps.size(); ++i) {
+        EXPECT_EQ(overlaps[i]->q_id_, sorted_overlaps[i]->q_id_);
+        EXPECT_EQ(overlaps[i]->q_begin_, sorted_overlaps[i]->q_begin_);
+        EXPECT_EQ(overlaps[i]->q_end_, sorted_overlaps[i]->q_end_);
+        EXPECT_EQ(overlaps[i]->q_length_, sorted_overlaps[i]->q_length_);
+        EXPECT_EQ(overlaps[i]->t_id_, sorted_overlaps[i]->t_id_);
+        EXPECT_EQ(overlaps[i]->t_begin_, sorted_overlaps[i]->t_begin_);
+        EXPECT_EQ(overlaps[i]->t_end_, sorted_overlaps[i]->t_end_);
+        EXPECT_EQ(overlaps[i]->t_length_, sorted_overlaps[i]->t_length_);
+        EXPECT_EQ(overlaps[i]->orientation_,
+            sorted_overlaps[i]->orientation_);
+        EXPECT_EQ(overlaps[i]->error_, sorted_overlaps[i]->error_);
+        EXPECT_EQ(overlaps[i]->minmers_, sorted_overlaps[i]->minmers_);
+    }
+}
+
+TEST_F(BioparserMhapTest, SortKeepsOutputOnError) {
+
+    std::string input_path = "bioparser_sort_invalid.mhap";
+    std::ofstream(input_path) << "1 2 0.1 5\n";
+
+    std::string path = "bioparser_sorted_invalid.mhap";
+    std::ofstream(path) << "previous\n";
+
+    try {
+        bioparser::sortOverlaps<bioparser::MhapParser>(input_path, path);
+        ADD_FAILURE();
+    } catch (const std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(),
+            "[bioparser::MhapParser] error: invalid file format!");
+    }
+    std::remove(input_path.c_str());
+
+    std::ifstream output(path);
+    std::string content((std::istreambuf_iterator<char>(output)),
+        std::istreambuf_iterator<char>());
+    output.close();
+    std::remove(path.c_str());
+
+    EXPECT_EQ("previous\n", content);
+}
+
+TEST_F(BioparserMhapTest, CompressedParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(150U, overlaps.size());
+    EXPECT_EQ(0U, name_size);
+    EXPECT_EQ(7822873U, total_value);
+}
+
+TEST_F(BioparserMhapTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (parser->parse(overlaps, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(150U, overlaps.size());
+    EXPECT_EQ(0U, name_size);
+    EXPECT_EQ(7822873U, total_value);
+}
+
+TEST_F(BioparserMhapTest, CompressedParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (parser->parse(overlaps, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(150U, overlaps.size());
+    EXPECT_EQ(0U, name_size);
+    EXPECT_EQ(7822873U, total_value);
+}
+
+TEST_F(BioparserMhapTest, FormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+
+    try {
+        parser->parse(overlaps, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserMhapTest, CompressedFormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.paf.gz");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+
+    try {
+        parser->parse(overlaps, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserPafTest, ParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+}
+
+TEST_F(BioparserPafTest, ParseInChunksWithRecordLimit) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    bioparser::BatchLimits limits;
+    limits.max_records = 64;
+    parser->set_limits(limits);
+
+    // batches are closed by whichever limit comes first
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (true) {
+        auto num_overlaps = overlaps.size();
+        auto status = parser->parse(overlaps, size_in_bytes);
+        EXPECT_LE(overlaps.size() - num_overlaps, limits.max_records);
+        if (!status) {
+            break;
+        }
+    }
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+}
+
+TEST_F(BioparserPafTest, ParseInterned) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    auto names = std::make_shared<bioparser::NameTable>();
+    EXPECT_EQ(0U, names->intern("seed"));
+
+    auto interned_parser = bioparser::createParser<bioparser::PafParser,
+        InternedOverlap>(bioparser_test_data_path + "sample.paf");
+    interned_parser->set_names(names);
+
+    std::vector<std::unique_ptr<InternedOverlap>> interned_overlaps;
+    interned_parser->parse(interned_overlaps, -1);
+
+    EXPECT_EQ(167U, names->size());
+    EXPECT_EQ(1U, interned_overlaps.front()->q_id_);
+    EXPECT_EQ(static_cast<std::uint32_t>(-1), names->id("missing"));
+
+    ASSERT_EQ(overlaps.size(), interned_overlaps.size());
+    for (std::uint32_t i = 0; i < overlaps.size(); ++i) {
+        EXPECT_EQ(overlaps[i]->q_name_,
+            names->name(interned_overlaps[i]->q_id_));
+        EXPECT_EQ(overlaps[i]->t_name_,
+            names->name(interned_overlaps[i]->t_id_));
+    }
+}
+
+TEST_F(BioparserPafTest, ParseInternedProjected) {
+
+    auto parser = bioparser::createParser<bioparser::PafParser,
+        InternedOverlap>(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<InternedOverlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    auto projected_parser = bioparser::createParser<bioparser::PafParser,
+        InternedOverlap>(bioparser_test_data_path + "sample.paf");
+    projected_parser->set_projection({9, 10});
+
+    std::vector<std::unique_ptr<InternedOverlap>> projected_overlaps;
+    projected_parser->parse(projected_overlaps, -1);
+
+    // names are still interned
+    EXPECT_EQ(parser->names()->size(), projected_parser->names()->size());
+    ASSERT_EQ(overlaps.size(), projected_overlaps.size());
+    for (std::uint32_t i = 0; i < overlaps.size(); ++i) {
+        EXPECT_EQ(overlaps[i]->q_id_, projected_overlaps[i]->q_id_);
+        EXPECT_EQ(overlaps[i]->t_id_, projected_overlaps[i]->t_id_);
+    }
+}
+
+TEST_F(BioparserPafTest, ParseIntoStoreInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    auto store_parser = bioparser::createParser<bioparser::PafParser,
+        Overlap>(bioparser_test_data_path + "sample.paf");
+
+    bioparser::OverlapStore store;
+    std::uint32_t size_in_bytes = 64 * 1024;
+    while (store_parser->parse(store, size_in_bytes)) {
+    }
+
+    EXPECT_EQ(500U, store.size());
+    EXPECT_LT(store.size_in_bytes(), 500U * sizeof(Overlap) / 4);
+    ASSERT_NE(nullptr, store.names());
+
+    std::vector<bioparser::OverlapStore::Record> expected;
+    for (const auto& it: overlaps) {
+        bioparser::OverlapStore::Record record = {
+            store.names()->id(it->q_name_), it->q_length_, it->q_begin_,
+            it->q_end_, it->orientation_, store.names()->id(it->t_name_),
+            it->t_length_, it->t_begin_, it->t_end_, it->matching_bases_,
+            it->overlap_length_, it->mapping_quality_};
+        expected.emplace_back(record);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+        [] (const bioparser::OverlapStore::Record& lhs,
+            const bioparser::OverlapStore::Record& rhs) -> bool {
+            return lhs.q_id < rhs.q_id || (lhs.q_id == rhs.q_id &&
+                (lhs.t_id < rhs.t_id || (lhs.t_id == rhs.t_id &&
+                lhs.q_begin < rhs.q_begin)));
+        });
+
+    std::uint32_t i = 0;
+    for (const auto& it: store) {
+        ASSERT_LT(i, expected.size());
+        const auto& jt = expected[i++];
+        EXPECT_EQ(jt.q_id, it.q_id);
+        EXPECT_EQ(jt.q_length, it.q_length);
+        EXPECT_EQ(jt.q_begin, it.q_begin);
+        EXPECT_EQ(jt.q_end, it.q_end);
+        EXPECT_EQ(jt.orientation, it.orientation);
+        EXPECT_EQ(jt.t_id, it.t_id);
+        EXPECT_EQ(jt.t_length, it.t_length);
+        EXPECT_EQ(jt.t_begin, it.t_begin);
+        EXPECT_EQ(jt.t_end, it.t_end);
+        EXPECT_EQ(jt.matching_bases, it.matching_bases);
+        EXPECT_EQ(jt.block_length, it.block_length);
+        EXPECT_EQ(jt.mapping_quality, it.mapping_quality);
+    }
+    EXPECT_EQ(500U, i);
+
+    std::uint64_t num_overlaps = 0;
+    for (std::uint32_t q_id = 0; q_id < store.num_queries(); ++q_id) {
+        for (auto it = store.begin(q_id); it != store.end(q_id); ++it) {
+            EXPECT_EQ(q_id, it->q_id);
+            ++num_overlaps;
+        }
+    }
+    EXPECT_EQ(500U, num_overlaps);
+    EXPECT_TRUE(store.begin(store.num_queries()) == store.end());
+}
+
+TEST_F(BioparserPafTest, WriteAndParse) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::string path = "bioparser_writer_sample.paf";
+    auto writer = bioparser::createWriter<bioparser::PafWriter>(path);
+    for (const auto& it: overlaps) {
+        writer->write(it->q_name_.c_str(), it->q_name_.size(), it->q_length_,
+            it->q_begin_, it->q_end_, it->orientation_, it->t_name_.c_str(),
+            it->t_name_.size(), it->t_length_, it->t_begin_, it->t_end_,
+            it->matching_bases_, it->overlap_length_, it->mapping_quality_);
+    }
+    writer->flush();
+
+    SetUp(path);
+
+    overlaps.clear();
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserPafTest, SortExternally) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    // two runs of at most 64 KiB
+    bioparser::SortOptions options;
+    options.max_bytes = 64 * 1024;
+    options.num_threads = 4;
+    options.directory = ".";
+
+    std::string path = "bioparser_sorted_sample.paf.gz";
+    bioparser::sortOverlaps<bioparser::PafParser>(
+        bioparser_test_data_path + "sample.paf", path, options);
+
+    std::vector<std::unique_ptr<Overlap>> sorted_overlaps;
+    bioparser::createParser<bioparser::PafParser, Overlap>(path)->parse(
+        sorted_overlaps, -1);
+    std::remove(path.c_str());
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, sorted_overlaps);
+
+    EXPECT_EQ(500U, sorted_overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+
+    std::stable_sort(overlaps.begin(), overlaps.end(),
+        [] (const std::unique_ptr<Overlap>& lhs,
+            const std::unique_ptr<Overlap>& rhs) -> bool {
+            return lhs->q_name_ < rhs->q_name_ || (lhs->q_name_ == rhs->q_name_ &&
+                (lhs->t_name_ < rhs->t_name_ || (lhs->t_name_ == rhs->t_name_ &&
+                (lhs->q_begin_ < rhs->q_begin_ || (lhs->q_begin_ == rhs->q_begin_ &&
+                lhs->t_begin_ < rhs->t_begin_)))));
+        });
+    for (std::uint32_t i = 0; i < overlaps.size(); ++i) {
+        EXPECT_EQ(overlaps[i]->q_name_, sorted_overlaps[i]->q_name_);
+        EXPECT_EQ(overlaps[i]->t_name_, sorted_overlaps[i]->t_name_);
+        EXPECT_EQ(overlaps[i]->q_end_, sorted_overlaps[i]->q_end_);
+        EXPECT_EQ(overlaps[i]->matching_bases_,
+            sorted_overlaps[i]->matching_bases_);
+    }
+}
+
+TEST_F(BioparserPafTest, CompressedParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.paf.gz");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+}
+
+TEST_F(BioparserPafTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (parser->parse(overlaps, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+}
+
+TEST_F(BioparserPafTest, ParseFilteredInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    bioparser::OverlapFilter filter;
+    filter.min_length = 1000;
+    filter.min_identity = 0.2;
+    filter.min_mapping_quality = 1;
+    filter.remove_self_overlaps = true;
+    static_cast<bioparser::PafParser<Overlap>*>(parser.get())->set_filter(
+        filter);
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (parser->parse(overlaps, size_in_bytes)) {
+    }
+
+    EXPECT_EQ(116U, overlaps.size());
+    for (const auto& it: overlaps) {
+        EXPECT_NE(it->q_name_, it->t_name_);
+        EXPECT_GE(it->matching_bases_, 0.2 * it->overlap_length_);
+    }
+}
+
+TEST_F(BioparserPafTest, FilteredFormatError) {
+
+    // the short overlap is rejected after nine columns
+    std::string path = "bioparser_filtered_error.paf";
+    std::ofstream(path) << "r1\t100\t0\t10\t+\tr2\t100\t0\t10\n";
+
+    SetUp(path);
+
+    bioparser::OverlapFilter filter;
+    filter.min_length = 1000;
+    static_cast<bioparser::PafParser<Overlap>*>(parser.get())->set_filter(
+        filter);
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    try {
+        parser->parse(overlaps, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::PafParser] error: "
+            "invalid file format!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserPafTest, ParseProjected) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, -1);
+
+    auto projected_parser = bioparser::createParser<bioparser::PafParser,
+        Overlap>(bioparser_test_data_path + "sample.paf");
+    projected_parser->set_projection({0, 9, 10});
+
+    std::vector<std::unique_ptr<Overlap>> projected_overlaps;
+    projected_parser->parse(projected_overlaps, -1);
+
+    ASSERT_EQ(overlaps.size(), projected_overlaps.size());
+    for (std::uint32_t i = 0; i < overlaps.size(); ++i) {
+        EXPECT_EQ(overlaps[i]->q_name_, projected_overlaps[i]->q_name_);
+        EXPECT_TRUE(projected_overlaps[i]->t_name_.empty());
+        EXPECT_EQ(0U, projected_overlaps[i]->q_begin_);
+        EXPECT_EQ(overlaps[i]->matching_bases_,
+            projected_overlaps[i]->matching_bases_);
+        EXPECT_EQ(overlaps[i]->overlap_length_,
+            projected_overlaps[i]->overlap_length_);
+    }
+}
+
+TEST_F(BioparserPafTest, CompressedParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.paf.gz");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    while (parser->parse(overlaps, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, total_value = 0;
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(500U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(18494208U, total_value);
+}
+
+TEST_F(BioparserPafTest, FormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+
+    try {
+        parser->parse(overlaps, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::PafParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserPafTest, CompressedFormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+
+    try {
+        parser->parse(overlaps, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::PafParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserPafTest, ParseWithCache) {
+
+    std::string path = "bioparser_cache_sample.paf";
+    ASSERT_TRUE(copy_file(bioparser_test_data_path + "sample.paf", path));
+    std::remove((path + ".bpc").c_str());
+
+    for (std::uint32_t i = 0; i < 2; ++i) {
+        SetUp(path);
+        parser->enable_cache();
+
+        std::vector<std::unique_ptr<Overlap>> overlaps;
+        parser->parse(overlaps, -1);
+
+        std::uint32_t name_size = 0, total_value = 0;
+        overlaps_summary(name_size, total_value, overlaps);
+
+        EXPECT_EQ(500U, overlaps.size());
+        EXPECT_EQ(96478U, name_size);
+        EXPECT_EQ(18494208U, total_value);
+        EXPECT_TRUE(file_exists(path + ".bpc"));
+    }
+
+    std::remove((path + ".bpc").c_str());
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserPafTest, ParseWithCacheOfRewrittenFile) {
+
+    std::string path = "bioparser_cache_rewritten.paf";
+    std::remove((path + ".bpc").c_str());
+
+    // rewritten to the same size, most likely within the same second
+    for (const auto& name: {"r1", "r2"}) {
+        std::ofstream(path) << name << "\t100\t0\t10\t+\tt\t100\t0\t10\t"
+            "10\t10\t255\n";
+
+        SetUp(path);
+        parser->enable_cache();
+
+        std::vector<std::unique_ptr<Overlap>> overlaps;
+        parser->parse(overlaps, -1);
+
+        ASSERT_EQ(1U, overlaps.size());
+        EXPECT_EQ(name, overlaps.front()->q_name_);
+        EXPECT_TRUE(file_exists(path + ".bpc"));
+    }
+
+    std::remove((path + ".bpc").c_str());
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserPafTest, ParseWithCacheTrimChange) {
+
+    std::string path = "bioparser_cache_trim.paf";
+    ASSERT_TRUE(copy_file(bioparser_test_data_path + "sample.paf", path));
+    std::remove((path + ".bpc").c_str());
+
+    SetUp(path);
+    parser->enable_cache();
+
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    parser->parse(overlaps, 64 * 1024);
+
+    try {
+        parser->parse(overlaps, 64 * 1024, false);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::Parser] error: "
+            "trim changed while the cache is open!");
+    }
+
+    overlaps.clear();
+    parser->reset();
+    parser->parse(overlaps, -1, false);
+    EXPECT_EQ(500U, overlaps.size());
+
+    std::remove((path + ".bpc").c_str());
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserPafTest, SortKeepsOptionalColumns) {
+
+    bioparser::SortOptions options;
+    options.max_bytes = 64 * 1024;
+    options.directory = ".";
+
+    std::string path = "bioparser_sorted_sample.paf";
+    bioparser::sortOverlaps<bioparser::PafParser>(
+        bioparser_test_data_path + "sample.paf", path, options);
+
+    auto read_lines = [] (const std::string& path) -> std::vector<std::string> {
+        std::ifstream input(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(input, line);) {
+            lines.emplace_back(line);
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    };
+
+    auto lines = read_lines(bioparser_test_data_path + "sample.paf");
+    auto sorted_lines = read_lines(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(500U, lines.size());
+    EXPECT_EQ(lines, sorted_lines);
+}
+
+TEST_F(BioparserSamTest, ParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+}
+
+TEST_F(BioparserSamTest, ParseAndReset) {
+
+    SetUp(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    // @SQ lines are read again without being reported as duplicates
+    alignments.clear();
+    parser->reset();
+    parser->parse(alignments, -1);
+
+    auto sam_parser = static_cast<bioparser::SamParser<Alignment>*>(
+        parser.get());
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(1U, sam_parser->header().size());
+    EXPECT_EQ(48502U, sam_parser->header().length(0));
+}
+
+TEST(BioparserSamTagsTest, ParseTags) {
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        TaggedAlignment>(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<TaggedAlignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint32_t num_tags = 0, num_primary = 0;
+    std::int64_t edit_distance = 0;
+    double divergence = 0;
+    for (const auto& it: alignments) {
+        num_tags += it->num_tags_;
+        num_primary += it->type_ == 'P';
+        edit_distance += it->edit_distance_;
+        divergence += it->divergence_;
+    }
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(342U, num_tags);
+    EXPECT_EQ(38U, num_primary);
+    EXPECT_EQ(52485, edit_distance);
+    EXPECT_NEAR(4.4284, divergence, 1e-9);
+}
+
+TEST(BioparserSamTagsTest, ParseIntegerTags) {
+
+    std::string path = "bioparser_integer_tags.sam";
+    {
+        std::ofstream output(path);
+        for (const auto& it: {"7", "-9223372036854775808",
+            "9223372036854775807", "9223372036854775808",
+            "99999999999999999999", "-", "1x"}) {
+            output << "r\t4\t*\t0\t0\t*\t*\t0\t0\t*\t*\tNM:i:" << it <<
+                "\n";
+        }
+    }
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        TaggedAlignment>(path);
+
+    std::vector<std::unique_ptr<TaggedAlignment>> alignments;
+    parser->parse(alignments, -1);
+    std::remove(path.c_str());
+
+    // values out of range or with other characters are not found
+    ASSERT_EQ(7U, alignments.size());
+    EXPECT_EQ(7, alignments[0]->edit_distance_);
+    EXPECT_EQ(INT64_MIN, alignments[1]->edit_distance_);
+    EXPECT_EQ(INT64_MAX, alignments[2]->edit_distance_);
+    for (std::uint32_t i = 3; i < alignments.size(); ++i) {
+        EXPECT_EQ(0, alignments[i]->edit_distance_);
+    }
+}
+
+TEST(BioparserSamCigarTest, ParseCigar) {
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        CigarAlignment>(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<CigarAlignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint64_t num_operations = 0, query_span = 0, target_span = 0,
+        aligned_bases = 0, insertions = 0, deletions = 0;
+    for (const auto& it: alignments) {
+        std::string cigar;
+        for (const auto& jt: it->operations_) {
+            cigar += std::to_string(jt >> 4) + "MIDNSHP=X"[jt & 0xF];
+        }
+        EXPECT_EQ(it->cigar_ == "*" ? "" : it->cigar_, cigar);
+
+        num_operations += it->operations_.size();
+        query_span += it->query_span_;
+        target_span += it->target_span_;
+        aligned_bases += it->aligned_bases_;
+        insertions += it->insertions_;
+        deletions += it->deletions_;
+    }
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(39898U, num_operations);
+    EXPECT_EQ(280870U, query_span);
+    EXPECT_EQ(257309U, target_span);
+    EXPECT_EQ(235633U, aligned_bases);
+    EXPECT_EQ(14366U, insertions);
+    EXPECT_EQ(21676U, deletions);
+}
+
+TEST(BioparserSamCigarTest, ParseCigarFiltered) {
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        CigarAlignment>(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<CigarAlignment>> alignments;
+    parser->parse(alignments, -1);
+
+    // the CIGAR decoded by the filter is passed to the constructor
+    auto filtered_parser = bioparser::createParser<bioparser::SamParser,
+        CigarAlignment>(bioparser_test_data_path + "sample.sam");
+    bioparser::OverlapFilter filter;
+    filter.min_length = 1;
+    filtered_parser->set_filter(filter);
+
+    std::vector<std::unique_ptr<CigarAlignment>> filtered_alignments;
+    filtered_parser->parse(filtered_alignments, -1);
+
+    std::uint32_t j = 0;
+    for (const auto& it: alignments) {
+        if (it->target_span_ == 0) {
+            continue;
+        }
+        ASSERT_LT(j, filtered_alignments.size());
+        EXPECT_EQ(it->operations_, filtered_alignments[j]->operations_);
+        EXPECT_EQ(it->target_span_, filtered_alignments[j]->target_span_);
+        ++j;
+    }
+    EXPECT_EQ(j, filtered_alignments.size());
+}
+
+TEST(BioparserSamReferenceTest, ParseReferenceIds) {
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        ReferenceAlignment>(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<ReferenceAlignment>> alignments;
+    parser->parse(alignments, -1);
+
+    const auto& header = parser->header();
+    EXPECT_EQ(1U, header.size());
+    EXPECT_EQ("NC_001416.1", header.name(0));
+    EXPECT_EQ(48502U, header.length(0));
+    EXPECT_EQ(0U, header.id("NC_001416.1"));
+    EXPECT_EQ(static_cast<std::uint32_t>(-1), header.id("NC_001416.2"));
+
+    std::uint32_t num_mapped = 0, num_unmapped = 0, num_next_unmapped = 0;
+    for (const auto& it: alignments) {
+        num_mapped += it->t_id_ == 0;
+        num_unmapped += it->t_id_ == static_cast<std::uint32_t>(-1);
+        num_next_unmapped += it->t_next_id_ == static_cast<std::uint32_t>(-1);
+    }
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(38U, num_mapped);
+    EXPECT_EQ(10U, num_unmapped);
+    EXPECT_EQ(48U, num_next_unmapped);
+}
+
+TEST(BioparserSamReferenceTest, MissingReferenceError) {
+
+    std::string path = "bioparser_missing_reference.sam";
+    std::ofstream(path) << "@SQ\tSN:1\tLN:10\n"
+        "r\t0\t2\t1\t60\t4M\t*\t0\t0\tACGT\t!!!!\n";
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        ReferenceAlignment>(path);
+
+    std::vector<std::unique_ptr<ReferenceAlignment>> alignments;
+    try {
+        parser->parse(alignments, -1);
+        ADD_FAILURE();
+    } catch (const std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
+            "reference 2 is missing from the header!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(BioparserSamReferenceTest, DuplicateReferenceError) {
+
+    std::string path = "bioparser_duplicate_reference.sam";
+    std::ofstream(path) << "@SQ\tSN:1\tLN:10\n@SQ\tSN:1\tLN:20\n"
+        "r\t0\t1\t1\t60\t4M\t*\t0\t0\tACGT\t!!!!\n";
+
+    auto parser = bioparser::createParser<bioparser::SamParser,
+        ReferenceAlignment>(path);
+
+    std::vector<std::unique_ptr<ReferenceAlignment>> alignments;
+    try {
+        parser->parse(alignments, -1);
+        ADD_FAILURE();
+    } catch (const std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
+            "duplicate reference 1 in the header!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserSamTest, ParseFiltered) {
+
+    SetUp(bioparser_test_data_path + "sample.sam");
+
+    bioparser::OverlapFilter filter;
+    filter.min_length = 2000;
+    filter.min_mapping_quality = 1;
+    filter.excluded_flags = 0x904;
+    static_cast<bioparser::SamParser<Alignment>*>(parser.get())->set_filter(
+        filter);
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    EXPECT_EQ(35U, alignments.size());
+    for (const auto& it: alignments) {
+        EXPECT_EQ(0U, it->flag_ & 0x904);
+        EXPECT_LE(1U, it->mapping_quality_);
+    }
+}
+
+TEST_F(BioparserSamTest, FilteredFormatError) {
+
+    // the unmapped record is rejected after two columns
+    std::string path = "bioparser_filtered_error.sam";
+    std::ofstream(path) << "r\t4\t*\t0\n";
+
+    SetUp(path);
+
+    bioparser::OverlapFilter filter;
+    filter.excluded_flags = 0x4;
+    static_cast<bioparser::SamParser<Alignment>*>(parser.get())->set_filter(
+        filter);
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    try {
+        parser->parse(alignments, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
+            "invalid file format!");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserSamTest, ParseProjected) {
+
+    auto projected_parser = bioparser::createParser<bioparser::SamParser,
+        TaggedAlignment>(bioparser_test_data_path + "sample.sam");
+    projected_parser->set_projection({0, 1, 3});
+
+    std::vector<std::unique_ptr<TaggedAlignment>> alignments;
+    projected_parser->parse(alignments, -1);
+
+    std::uint32_t num_tags = 0;
+    for (const auto& it: alignments) {
+        EXPECT_TRUE(it->t_name_.empty());
+        EXPECT_TRUE(it->cigar_.empty());
+        EXPECT_TRUE(it->sequence_.empty());
+        EXPECT_TRUE(it->quality_.empty());
+        num_tags += it->num_tags_;
+    }
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(342U, num_tags);
+}
+
+TEST_F(BioparserSamTest, CompressedWriteAndParse) {
+
+    SetUp(bioparser_test_data_path + "sample.sam");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::string path = "bioparser_writer_sample.sam.gz";
+    {
+        auto writer = bioparser::createWriter<bioparser::SamWriter>(path);
+        writer->set_num_threads(4);
+        std::string header = "@HD\tVN:1.6\n";
+        writer->write_header(header.c_str(), header.size());
+        for (const auto& it: alignments) {
+            writer->write(it->q_name_.c_str(), it->q_name_.size(), it->flag_,
+                it->t_name_.c_str(), it->t_name_.size(), it->t_begin_,
+                it->mapping_quality_, it->cigar_.c_str(), it->cigar_.size(),
+                it->t_next_name_.c_str(), it->t_next_name_.size(),
+                it->t_next_begin_, it->template_length_,
+                it->sequence_.c_str(), it->sequence_.size(),
+                it->quality_.c_str(), it->quality_.size());
+        }
+    }
+
+    SetUp(path);
+
+    alignments.clear();
+    parser->parse(alignments, -1);
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(BioparserSamTest, CompressedParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.sam.gz");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+}
+
+TEST_F(BioparserSamTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.sam");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    while (parser->parse(alignments, size_in_bytes)) {
+    }
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+}
+
+TEST_F(BioparserSamTest, CompressedParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.sam.gz");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    while (parser->parse(alignments, size_in_bytes)) {
+    }
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+}
+
+TEST_F(BioparserSamTest, FormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.paf");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+
+    try {
+        parser->parse(alignments, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserSamTest, CompressedFormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.paf.gz");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+
+    try {
+        parser->parse(alignments, -1);
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserBamTest, ParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.bam");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+
+    auto bam_parser = static_cast<bioparser::BamParser<Alignment>*>(
+        parser.get());
+    EXPECT_EQ(1U, bam_parser->header().size());
+    EXPECT_EQ(48502U, bam_parser->header().length(0));
+}
+
+TEST_F(BioparserBamTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.bam");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    while (parser->parse(alignments, size_in_bytes)) {
+    }
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_EQ(48U, alignments.size());
+    EXPECT_EQ(795237U, string_size);
+    EXPECT_EQ(639677U, total_value);
+}
+
+TEST_F(BioparserBamTest, ParseAndReset) {
+
+    SetUp(bioparser_test_data_path + "sample.bam");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    parser->parse(alignments, -1);
+
+    std::uint32_t num_alignments = alignments.size(), string_size = 0,
+        total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    alignments.clear();
+    parser->reset();
+    while (parser->parse(alignments, size_in_bytes)) {
+    }
+
+    std::uint32_t num_alignments_new = alignments.size(), string_size_new = 0,
+        total_value_new = 0;
+    alignments_summary(string_size_new, total_value_new, alignments);
+
+    EXPECT_EQ(num_alignments_new, num_alignments);
+    EXPECT_EQ(string_size_new, string_size);
+    EXPECT_EQ(total_value_new, total_value);
+}
+
+TEST_F(BioparserBamTest, FormatError) {
+
+    SetUp(bioparser_test_data_path + "sample.sam.gz");
+
+    std::vector<std::unique_ptr<Alignment>> alignments;
+
+    try {
+        parser->parse(alignments, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::BamParser] error: "
+            "invalid file format!");
+    }
+}
+
+TEST_F(BioparserBamTest, ChunkSizeError) {
+
+    SetUp(bioparser_test_data_path + "sample.bam");
+
+    std::uint32_t size_in_bytes = 10 * 1024;
+    std::vector<std::unique_ptr<Alignment>> alignments;
+
+    try {
+        parser->parse(alignments, size_in_bytes);
+    } catch (bioparser::ChunkSizeError& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::BamParser] error: "
+            "too small chunk size!");
+    }
+}
+
+TEST_F(BioparserGfaTest, ParseWhole) {
+
+    SetUp(bioparser_test_data_path + "sample.gfa");
+
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    parser->parse(elements, -1);
+
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
+
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(208U, other_size);
+}
+
+TEST_F(BioparserGfaTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.gfa");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    while (parser->parse(elements, size_in_bytes)) {
+    }
 
-TEST_F(BioparserFastqTest, CompressedChunkSizeError) {
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
 
-    SetUp(bioparser_test_data_path + "sample.fastq.gz");
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(208U, other_size);
+}
 
-    std::uint32_t size_in_bytes = 10 * 1024;
-    std::vector<std::unique_ptr<Read>> reads;
+TEST_F(BioparserGfaTest, ParseWithoutSequences) {
 
-    try {
-        parser->parse(reads, size_in_bytes);
-    } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::FastqParser] error: "
-            "too small chunk size!");
+    SetUp(bioparser_test_data_path + "sample.gfa");
+    parser->set_skip_sequences(true);
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    while (parser->parse(elements, size_in_bytes)) {
     }
+
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
+
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(0U, sequence_size);
+    EXPECT_EQ(208U, other_size);
 }
 
-TEST_F(BioparserMhapTest, ParseWhole) {
+TEST_F(BioparserGfaTest, ParseWithoutSequencesOrTags) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap");
+    std::string path = "bioparser_untagged.gfa";
+    for (const auto& header: {"H\tVN:Z:1.0\nS\t1\tACGT\nS\t2\tGGGG\n",
+        "H\tVN:Z:2.0\nS\t1\t4\tACGT\nS\t2\t4\tGGGG\n"}) {
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    parser->parse(overlaps, -1);
+        std::ofstream(path) << header << "L\t1\t+\t2\t-\t0M\n";
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+        for (bool skip_sequences: {false, true}) {
+            SetUp(path);
+            parser->set_skip_sequences(skip_sequences);
 
-    EXPECT_EQ(150U, overlaps.size());
-    EXPECT_EQ(0U, name_size);
-    EXPECT_EQ(7822873U, total_value);
+            std::vector<std::unique_ptr<GraphElement>> elements;
+            parser->parse(elements, -1);
+
+            ASSERT_EQ(3U, elements.size());
+            EXPECT_EQ("1", elements[0]->name_);
+            EXPECT_EQ(skip_sequences ? "" : "ACGT", elements[0]->sequence_);
+            EXPECT_EQ("2", elements[1]->name_);
+            EXPECT_EQ(skip_sequences ? "" : "GGGG", elements[1]->sequence_);
+            EXPECT_EQ('L', elements[2]->type_);
+        }
+    }
+    std::remove(path.c_str());
 }
 
-TEST_F(BioparserMhapTest, CompressedParseWhole) {
+TEST_F(BioparserGfaTest, CompressedParseWhole) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+    SetUp(bioparser_test_data_path + "sample.gfa.gz");
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    parser->parse(overlaps, -1);
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    parser->parse(elements, -1);
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
 
-    EXPECT_EQ(150U, overlaps.size());
-    EXPECT_EQ(0U, name_size);
-    EXPECT_EQ(7822873U, total_value);
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(208U, other_size);
 }
 
-TEST_F(BioparserMhapTest, ParseInChunks) {
+TEST_F(BioparserGfaTest, CompressedParseInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap");
+    SetUp(bioparser_test_data_path + "sample.gfa.gz");
 
     std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    while (parser->parse(overlaps, size_in_bytes)) {
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    while (parser->parse(elements, size_in_bytes)) {
     }
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
 
-    EXPECT_EQ(150U, overlaps.size());
-    EXPECT_EQ(0U, name_size);
-    EXPECT_EQ(7822873U, total_value);
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(208U, other_size);
 }
 
-TEST_F(BioparserMhapTest, CompressedParseInChunks) {
+TEST_F(BioparserGfaTest, CompressedParseWithoutSequences) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+    SetUp(bioparser_test_data_path + "sample.gfa.gz");
+    parser->set_skip_sequences(true);
 
     std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    while (parser->parse(overlaps, size_in_bytes)) {
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    while (parser->parse(elements, size_in_bytes)) {
     }
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
-
-    EXPECT_EQ(150U, overlaps.size());
-    EXPECT_EQ(0U, name_size);
-    EXPECT_EQ(7822873U, total_value);
+    std::uint32_t num_segments = 0, num_links = 0, num_paths = 0,
+        name_size = 0, sequence_size = 0, other_size = 0;
+    graph_summary(num_segments, num_links, num_paths, name_size,
+        sequence_size, other_size, elements);
+
+    EXPECT_EQ(14U, num_segments);
+    EXPECT_EQ(13U, num_links);
+    EXPECT_EQ(1U, num_paths);
+    EXPECT_EQ(174U, name_size);
+    EXPECT_EQ(0U, sequence_size);
+    EXPECT_EQ(208U, other_size);
 }
 
-TEST_F(BioparserMhapTest, FormatError) {
+TEST_F(BioparserGfaTest, FormatError) {
 
     SetUp(bioparser_test_data_path + "sample.paf");
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
+    std::vector<std::unique_ptr<GraphElement>> elements;
 
     try {
-        parser->parse(overlaps, -1);
+        parser->parse(elements, -1);
+        ADD_FAILURE();
     } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
+        EXPECT_STREQ(exception.what(), "[bioparser::GfaParser] error: "
             "invalid file format!");
     }
 }
 
-TEST_F(BioparserMhapTest, CompressedFormatError) {
+TEST_F(BioparserTwoBitTest, ParseWhole) {
 
-    SetUp(bioparser_test_data_path + "sample.paf.gz");
+    SetUp(bioparser_test_data_path + "sample.2bit");
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
+    std::vector<std::unique_ptr<Read>> reads;
+    parser->parse(reads, -1);
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_EQ(65U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(0U, quality_size);
+}
+
+TEST_F(BioparserTwoBitTest, ParseInChunks) {
+
+    SetUp(bioparser_test_data_path + "sample.2bit");
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (parser->parse(reads, size_in_bytes)) {
+    }
+
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
+
+    EXPECT_EQ(14U, reads.size());
+    EXPECT_EQ(65U, name_size);
+    EXPECT_EQ(109117U, sequence_size);
+    EXPECT_EQ(0U, quality_size);
+}
+
+TEST_F(BioparserTwoBitTest, Fetch) {
+
+    std::vector<std::unique_ptr<Read>> reads;
+    bioparser::createParser<bioparser::FastaParser, Read>(
+        bioparser_test_data_path + "sample.fasta")->parse(reads, -1);
+
+    SetUp(bioparser_test_data_path + "sample.2bit");
+
+    EXPECT_EQ(14U, parser->sequence_names().size());
+    EXPECT_EQ(reads[3]->sequence_.size(), parser->sequence_length("3"));
+    EXPECT_EQ(reads[3]->sequence_.substr(1, 777), parser->fetch("3", 1, 778));
+    EXPECT_EQ(reads[12]->sequence_, parser->fetch("12", 0,
+        reads[12]->sequence_.size()));
+
+    // the first sequence has masked and N blocks at [0, 100), [200, 300)
+    // and [1000, 1010)
+    auto to_lower = [] (std::string src) -> std::string {
+        for (auto& it: src) {
+            it = std::tolower(it);
+        }
+        return src;
+    };
+    const auto& sequence = reads[0]->sequence_;
+    EXPECT_EQ(to_lower(sequence.substr(0, 100)) + sequence.substr(100, 100) +
+        std::string(100, 'N') + sequence.substr(300, 3),
+        parser->fetch("1", 0, 303));
+    EXPECT_EQ(sequence.substr(998, 2) + to_lower(sequence.substr(1000, 10)) +
+        sequence.substr(1010, 1), parser->fetch("1", 998, 1011));
+    // ranges starting inside or after blocks reuse the decoded tables
+    EXPECT_EQ(to_lower(sequence.substr(50, 10)), parser->fetch("1", 50, 60));
+    EXPECT_EQ(std::string(50, 'N') + sequence.substr(300, 700) +
+        to_lower(sequence.substr(1000, 5)), parser->fetch("1", 250, 1005));
+    EXPECT_EQ(sequence.substr(1010, 90), parser->fetch("1", 1010, 1100));
+}
+
+TEST_F(BioparserTwoBitTest, FetchError) {
+
+    SetUp(bioparser_test_data_path + "sample.2bit");
 
     try {
-        parser->parse(overlaps, -1);
+        parser->fetch("3", 10, 1000000);
+        ADD_FAILURE();
     } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::MhapParser] error: "
-            "invalid file format!");
+        EXPECT_STREQ(exception.what(), "[bioparser::TwoBitParser] error: "
+            "invalid range of sequence 3!");
     }
 }
 
-TEST_F(BioparserPafTest, ParseWhole) {
-
-    SetUp(bioparser_test_data_path + "sample.paf");
+TEST_F(BioparserTwoBitTest, FormatError) {
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    parser->parse(overlaps, -1);
+    SetUp(bioparser_test_data_path + "sample.fasta");
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+    std::vector<std::unique_ptr<Read>> reads;
 
-    EXPECT_EQ(500U, overlaps.size());
-    EXPECT_EQ(96478U, name_size);
-    EXPECT_EQ(18494208U, total_value);
+    try {
+        parser->parse(reads, -1);
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), "[bioparser::TwoBitParser] error: "
+            "invalid file format!");
+    }
 }
 
-TEST_F(BioparserPafTest, CompressedParseWhole) {
+TEST_F(BioparserBedTest, ParseWhole) {
 
-    SetUp(bioparser_test_data_path + "sample.paf.gz");
+    SetUp(bioparser_test_data_path + "sample.bed");
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    parser->parse(overlaps, -1);
+    std::vector<std::unique_ptr<Interval>> intervals;
+    parser->parse(intervals, -1);
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+    std::uint32_t chromosome_size = 0, length = 0, name_size = 0, score = 0,
+        num_reverse = 0;
+    intervals_summary(chromosome_size, length, name_size, score, num_reverse,
+        intervals);
 
-    EXPECT_EQ(500U, overlaps.size());
-    EXPECT_EQ(96478U, name_size);
-    EXPECT_EQ(18494208U, total_value);
+    EXPECT_EQ(4000U, intervals.size());
+    EXPECT_EQ(16000U, chromosome_size);
+    EXPECT_EQ(10025515U, length);
+    EXPECT_EQ(28588U, name_size);
+    EXPECT_EQ(1343097U, score);
+    EXPECT_EQ(1348U, num_reverse);
 }
 
-TEST_F(BioparserPafTest, ParseInChunks) {
+TEST_F(BioparserBedTest, CompressedParseInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.paf");
+    SetUp(bioparser_test_data_path + "sample.bed.gz");
 
     std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    while (parser->parse(overlaps, size_in_bytes)) {
+    std::vector<std::unique_ptr<Interval>> intervals;
+    while (parser->parse(intervals, size_in_bytes)) {
     }
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
-
-    EXPECT_EQ(500U, overlaps.size());
-    EXPECT_EQ(96478U, name_size);
-    EXPECT_EQ(18494208U, total_value);
+    std::uint32_t chromosome_size = 0, length = 0, name_size = 0, score = 0,
+        num_reverse = 0;
+    intervals_summary(chromosome_size, length, name_size, score, num_reverse,
+        intervals);
+
+    EXPECT_EQ(4000U, intervals.size());
+    EXPECT_EQ(16000U, chromosome_size);
+    EXPECT_EQ(10025515U, length);
+    EXPECT_EQ(28588U, name_size);
+    EXPECT_EQ(1343097U, score);
+    EXPECT_EQ(1348U, num_reverse);
 }
 
-TEST_F(BioparserPafTest, CompressedParseInChunks) {
+TEST_F(BioparserBedTest, ParseIntervalsInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.paf.gz");
+    SetUp(bioparser_test_data_path + "sample.bed");
 
     std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Overlap>> overlaps;
-    while (parser->parse(overlaps, size_in_bytes)) {
+    bioparser::BedIntervals intervals;
+    while (parser->parse(intervals, size_in_bytes)) {
     }
 
-    std::uint32_t name_size = 0, total_value = 0;
-    overlaps_summary(name_size, total_value, overlaps);
+    EXPECT_EQ(3U, intervals.names().size());
+    EXPECT_EQ(4000U, intervals.begins().size());
+    EXPECT_EQ(4U, intervals.offsets().size());
+    EXPECT_EQ(4000U, intervals.offsets().back());
 
-    EXPECT_EQ(500U, overlaps.size());
-    EXPECT_EQ(96478U, name_size);
-    EXPECT_EQ(18494208U, total_value);
+    std::uint32_t length = 0;
+    for (std::uint32_t i = 0; i < intervals.begins().size(); ++i) {
+        length += intervals.ends()[i] - intervals.begins()[i];
+    }
+    EXPECT_EQ(10025515U, length);
+
+    auto chr1 = intervals.id("chr1");
+    EXPECT_EQ(1328U, intervals.offsets()[chr1 + 1] - intervals.offsets()[chr1]);
+    EXPECT_EQ(12588U, intervals.begins()[intervals.offsets()[chr1]]);
+    EXPECT_TRUE(std::is_sorted(intervals.begins().begin() +
+        intervals.offsets()[chr1], intervals.begins().begin() +
+        intervals.offsets()[chr1 + 1]));
+    EXPECT_EQ(-1U, intervals.id("chr3"));
+
+    EXPECT_FALSE(intervals.overlaps("chr1", 12000, 12588));
+    EXPECT_TRUE(intervals.overlaps("chr1", 12000, 12589));
+    EXPECT_FALSE(intervals.overlaps("chr1", 15755, 26562));
+    EXPECT_TRUE(intervals.overlaps("chr1", 15754, 15755));
+    // [72908, 73806) is nested in [72821, 75285)
+    EXPECT_TRUE(intervals.overlaps("chr1", 74000, 74001));
+    EXPECT_FALSE(intervals.overlaps("chr1", 75285, 82340));
+    EXPECT_FALSE(intervals.overlaps("chr3", 0, 100000));
+
+    // merging chunks into sorted intervals matches sorting them at once
+    SetUp(bioparser_test_data_path + "sample.bed");
+    bioparser::BedIntervals whole;
+    parser->parse(whole, -1);
+    EXPECT_EQ(whole.offsets(), intervals.offsets());
+    EXPECT_EQ(whole.begins(), intervals.begins());
+    EXPECT_EQ(whole.ends(), intervals.ends());
+    EXPECT_EQ(whole.max_ends(), intervals.max_ends());
 }
 
-TEST_F(BioparserPafTest, FormatError) {
+TEST_F(BioparserBedTest, InvalidNumbers) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap");
+    std::string path = "bioparser_invalid_numbers.bed";
+    std::ofstream(path) << "chr1\t10\t20\tr1\t5.3\t+\n"
+        "chr1\t10\t20\tr2\t4294967296\t+\n";
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
+    SetUp(path);
+    std::vector<std::unique_ptr<Interval>> intervals;
+    parser->parse(intervals, -1);
 
+    ASSERT_EQ(2U, intervals.size());
+    EXPECT_EQ(0U, intervals[0]->score_);
+    EXPECT_EQ(0U, intervals[1]->score_);
+
+    std::ofstream(path) << "chr1\t10\t4294967306\n";
+
+    SetUp(path);
+    intervals.clear();
     try {
-        parser->parse(overlaps, -1);
+        parser->parse(intervals, -1);
+        ADD_FAILURE();
     } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::PafParser] error: "
+        EXPECT_STREQ(exception.what(), "[bioparser::BedParser] error: "
             "invalid file format!");
     }
+
+    std::remove(path.c_str());
 }
 
-TEST_F(BioparserPafTest, CompressedFormatError) {
+TEST_F(BioparserBedTest, FormatError) {
 
-    SetUp(bioparser_test_data_path + "sample.mhap.gz");
+    SetUp(bioparser_test_data_path + "sample.fasta");
 
-    std::vector<std::unique_ptr<Overlap>> overlaps;
+    std::vector<std::unique_ptr<Interval>> intervals;
 
     try {
-        parser->parse(overlaps, -1);
+        parser->parse(intervals, -1);
+        ADD_FAILURE();
     } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::PafParser] error: "
+        EXPECT_STREQ(exception.what(), "[bioparser::BedParser] error: "
             "invalid file format!");
     }
 }
 
-TEST_F(BioparserSamTest, ParseWhole) {
+TEST(BioparserCreateParserTest, DetectFormat) {
 
-    SetUp(bioparser_test_data_path + "sample.sam");
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    std::vector<std::unique_ptr<Read>> reads;
+    bioparser::createParser<Read>(bioparser_test_data_path +
+        "sample.fasta.gz")->parse(reads, -1);
+    bioparser::createParser<Read>(bioparser_test_data_path +
+        "sample_single_line.fastq")->parse(reads, -1);
+    reads_summary(name_size, sequence_size, quality_size, reads);
 
-    std::vector<std::unique_ptr<Alignment>> alignments;
-    parser->parse(alignments, -1);
+    EXPECT_EQ(27U, reads.size());
+    EXPECT_EQ(82U, name_size);
+    EXPECT_EQ(217257U, sequence_size);
+    EXPECT_EQ(108140U, quality_size);
 
-    std::uint32_t string_size = 0, total_value = 0;
+    name_size = 0;
+    std::uint32_t total_value = 0;
+    std::vector<std::unique_ptr<Overlap>> overlaps;
+    bioparser::createParser<Overlap>(bioparser_test_data_path +
+        "sample.mhap")->parse(overlaps, -1);
+    bioparser::createParser<Overlap>(bioparser_test_data_path +
+        "sample.paf.gz")->parse(overlaps, -1);
+    overlaps_summary(name_size, total_value, overlaps);
+
+    EXPECT_EQ(650U, overlaps.size());
+    EXPECT_EQ(96478U, name_size);
+    EXPECT_EQ(7822873U + 18494208U, total_value);
+
+    std::uint32_t string_size = 0;
+    total_value = 0;
+    std::vector<std::unique_ptr<Alignment>> alignments;
+    bioparser::createParser<Alignment>(bioparser_test_data_path +
+        "sample.sam.gz")->parse(alignments, -1);
+    bioparser::createParser<Alignment>(bioparser_test_data_path +
+        "sample.bam")->parse(alignments, -1);
     alignments_summary(string_size, total_value, alignments);
 
-    EXPECT_EQ(48U, alignments.size());
-    EXPECT_EQ(795237U, string_size);
-    EXPECT_EQ(639677U, total_value);
-}
+    EXPECT_EQ(96U, alignments.size());
+    EXPECT_EQ(2 * 795237U, string_size);
+    EXPECT_EQ(2 * 639677U, total_value);
 
-TEST_F(BioparserSamTest, CompressedParseWhole) {
+    std::vector<std::unique_ptr<GraphElement>> elements;
+    bioparser::createParser<GraphElement>(bioparser_test_data_path +
+        "sample.gfa.gz")->parse(elements, -1);
 
-    SetUp(bioparser_test_data_path + "sample.sam.gz");
+    EXPECT_EQ(28U, elements.size());
 
-    std::vector<std::unique_ptr<Alignment>> alignments;
-    parser->parse(alignments, -1);
+    reads.clear();
+    bioparser::createParser<Read>(bioparser_test_data_path +
+        "sample.2bit")->parse(reads, -1);
 
-    std::uint32_t string_size = 0, total_value = 0;
-    alignments_summary(string_size, total_value, alignments);
+    EXPECT_EQ(14U, reads.size());
 
-    EXPECT_EQ(48U, alignments.size());
-    EXPECT_EQ(795237U, string_size);
-    EXPECT_EQ(639677U, total_value);
-}
+    std::vector<std::unique_ptr<Interval>> intervals;
+    bioparser::createParser<Interval>(bioparser_test_data_path +
+        "sample.bed.gz")->parse(intervals, -1);
 
-TEST_F(BioparserSamTest, ParseInChunks) {
+    EXPECT_EQ(4000U, intervals.size());
+}
 
-    SetUp(bioparser_test_data_path + "sample.sam");
+TEST(BioparserCreateParserTest, MissingConstructorError) {
 
-    std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Alignment>> alignments;
-    while (parser->parse(alignments, size_in_bytes)) {
+    try {
+        bioparser::createParser<Read>(bioparser_test_data_path + "sample.paf");
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), ("[bioparser::createParser] error: "
+            "missing constructor for the format of file " +
+            bioparser_test_data_path + "sample.paf!").c_str());
     }
+}
 
-    std::uint32_t string_size = 0, total_value = 0;
-    alignments_summary(string_size, total_value, alignments);
+TEST(BioparserCreateParserTest, MhapConstructorForPafError) {
 
-    EXPECT_EQ(48U, alignments.size());
-    EXPECT_EQ(795237U, string_size);
-    EXPECT_EQ(639677U, total_value);
+    // MHAP constructors are not taken for PAF constructors with read ids
+    EXPECT_TRUE(bioparser::MhapParser<MhapOverlap>::is_supported());
+    EXPECT_FALSE(bioparser::PafParser<MhapOverlap>::is_supported());
+    EXPECT_TRUE(bioparser::PafParser<InternedOverlap>::is_supported());
+
+    try {
+        bioparser::createParser<MhapOverlap>(bioparser_test_data_path +
+            "sample.paf");
+        ADD_FAILURE();
+    } catch (std::invalid_argument& exception) {
+        EXPECT_STREQ(exception.what(), ("[bioparser::createParser] error: "
+            "missing constructor for the format of file " +
+            bioparser_test_data_path + "sample.paf!").c_str());
+    }
 }
 
-TEST_F(BioparserSamTest, CompressedParseInChunks) {
+TEST(BioparserMultiParserTest, ParseInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.sam.gz");
+    std::vector<std::string> paths = {
+        bioparser_test_data_path + "sample.fastq",
+        bioparser_test_data_path + "sample.fastq.gz",
+        bioparser_test_data_path + "sample_single_line.fastq"};
+    auto parser = bioparser::createParser<bioparser::FastqParser, Read>(paths);
 
-    std::uint32_t size_in_bytes = 64 * 1024;
-    std::vector<std::unique_ptr<Alignment>> alignments;
-    while (parser->parse(alignments, size_in_bytes)) {
+    // files parsed one by one would take 6 batches
+    std::uint32_t size_in_bytes = 192 * 1024;
+    std::uint32_t num_batches = 0;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (true) {
+        ++num_batches;
+        if (!parser->parse(reads, size_in_bytes)) {
+            break;
+        }
     }
 
-    std::uint32_t string_size = 0, total_value = 0;
-    alignments_summary(string_size, total_value, alignments);
+    std::uint32_t name_size = 0, sequence_size = 0, quality_size = 0;
+    reads_summary(name_size, sequence_size, quality_size, reads);
 
-    EXPECT_EQ(48U, alignments.size());
-    EXPECT_EQ(795237U, string_size);
-    EXPECT_EQ(639677U, total_value);
+    EXPECT_EQ(39U, reads.size());
+    EXPECT_EQ(3 * 17U, name_size);
+    EXPECT_EQ(3 * 108140U, sequence_size);
+    EXPECT_EQ(3 * 108140U, quality_size);
+    EXPECT_EQ(4U, num_batches);
+
+    reads.clear();
+    parser->reset();
+    parser->parse(reads, -1);
+    EXPECT_EQ(39U, reads.size());
 }
 
-TEST_F(BioparserSamTest, FormatError) {
+TEST(BioparserMultiParserTest, ParsePrefetchedInChunks) {
 
-    SetUp(bioparser_test_data_path + "sample.paf");
+    std::vector<std::string> paths = {
+        bioparser_test_data_path + "sample.fasta",
+        bioparser_test_data_path + "sample_single_line.fasta",
+        bioparser_test_data_path + "sample.fasta.gz"};
+
+    std::vector<std::unique_ptr<Read>> expected;
+    for (const auto& it: paths) {
+        bioparser::createParser<bioparser::FastaParser, Read>(it)->parse(
+            expected, -1);
+    }
+
+    // prefetched first blocks are parsed in place of the file start
+    for (std::uint64_t size_in_bytes: {0ULL, 64 * 1024ULL, 256 * 1024ULL}) {
+        auto parser = bioparser::createParser<bioparser::FastaParser, Read>(
+            paths);
+        std::vector<std::unique_ptr<Read>> reads;
+        while (parser->parse(reads, size_in_bytes)) {
+        }
+
+        ASSERT_EQ(expected.size(), reads.size());
+        for (std::uint32_t i = 0; i < reads.size(); ++i) {
+            EXPECT_EQ(expected[i]->name_, reads[i]->name_);
+            EXPECT_EQ(expected[i]->sequence_, reads[i]->sequence_);
+        }
+    }
+}
 
+TEST(BioparserMultiParserTest, ParseBinaryInChunks) {
+
+    std::uint32_t size_in_bytes = 64 * 1024;
+    std::uint32_t num_file_batches = 0;
     std::vector<std::unique_ptr<Alignment>> alignments;
+    auto bam_parser = bioparser::createParser<bioparser::BamParser, Alignment>(
+        bioparser_test_data_path + "sample.bam");
+    while (true) {
+        ++num_file_batches;
+        if (!bam_parser->parse(alignments, size_in_bytes)) {
+            break;
+        }
+    }
 
-    try {
-        parser->parse(alignments, -1);
-    } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
-            "invalid file format!");
+    std::vector<std::string> paths = {
+        bioparser_test_data_path + "sample.bam",
+        bioparser_test_data_path + "sample.bam"};
+    auto parser = bioparser::createParser<bioparser::BamParser, Alignment>(
+        paths);
+
+    // batches do not span binary files whose bytes are not tracked
+    std::uint32_t num_batches = 0;
+    alignments.clear();
+    while (true) {
+        ++num_batches;
+        if (!parser->parse(alignments, size_in_bytes)) {
+            break;
+        }
     }
+
+    std::uint32_t string_size = 0, total_value = 0;
+    alignments_summary(string_size, total_value, alignments);
+
+    EXPECT_LT(1U, num_file_batches);
+    EXPECT_EQ(2 * num_file_batches, num_batches);
+    EXPECT_EQ(2 * 48U, alignments.size());
+    EXPECT_EQ(2 * 795237U, string_size);
 }
 
-TEST_F(BioparserSamTest, CompressedFormatError) {
+TEST(BioparserMultiParserTest, ParseWithRecordLimit) {
 
-    SetUp(bioparser_test_data_path + "sample.paf.gz");
+    std::vector<std::string> paths = {
+        bioparser_test_data_path + "sample.fastq",
+        bioparser_test_data_path + "sample.fastq.gz",
+        bioparser_test_data_path + "sample_single_line.fastq"};
+    auto parser = bioparser::createParser<bioparser::FastqParser, Read>(paths);
 
-    std::vector<std::unique_ptr<Alignment>> alignments;
+    bioparser::BatchLimits limits;
+    limits.max_records = 10;
+    parser->set_limits(limits);
 
-    try {
-        parser->parse(alignments, -1);
-    } catch (std::invalid_argument& exception) {
-        EXPECT_STREQ(exception.what(), "[bioparser::SamParser] error: "
-            "invalid file format!");
+    // batches span file boundaries
+    std::vector<std::uint32_t> batch_sizes;
+    std::vector<std::unique_ptr<Read>> reads;
+    while (true) {
+        auto num_reads = reads.size();
+        auto status = parser->parse(reads, -1);
+        batch_sizes.emplace_back(reads.size() - num_reads);
+        if (!status) {
+            break;
+        }
     }
+
+    EXPECT_EQ(std::vector<std::uint32_t>({10, 10, 10, 9}), batch_sizes);
+    EXPECT_EQ(39U, reads.size());
 }